@@ -1,27 +1,384 @@
 #include <iostream>
 #include <vector>
-#include <queue>
 #include <algorithm>
 #include <climits>
 #include <chrono>
 #include <random>
-#include <set>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <cstring>
+#include <utility>
+#include <string>
+#include <unordered_map>
+#include <cmath>
+#include <cstdio>
+#include <charconv>
+#include <type_traits>
+#include <thread>
+#include <cstdlib>
+#include <cerrno>
+#include <mutex>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 using namespace std;
 
+// Solve Arena 
+// monotonic bump allocator for per-solve scratch (AC-3 worklist).
+// reset() is O(1) and keeps the blocks, so repeated k probes stop hitting malloc.
+// Only trivially destructible types may live here.
+struct Arena {
+    static constexpr size_t BLOCK_SIZE = 1 << 20;
+    vector<unique_ptr<char[]>> blocks;
+    vector<size_t> capacity;
+    size_t cur = 0;   // block being carved
+    size_t used = 0;  // bytes used in blocks[cur]
+
+    void* allocBytes(size_t bytes, size_t align) {
+        while (true) {
+            if (cur < blocks.size()) {
+                size_t p = (used + align - 1) & ~(align - 1);
+                if (p + bytes <= capacity[cur]) {
+                    used = p + bytes;
+                    return blocks[cur].get() + p;
+                }
+                ++cur; used = 0; // does not fit, move on to the next retained block
+                continue;
+            }
+            size_t cap = max(BLOCK_SIZE, bytes + align);
+            blocks.emplace_back(new char[cap]);
+            capacity.push_back(cap);
+        }
+    }
+
+    template <class T>
+    T* alloc(size_t n) { return static_cast<T*>(allocBytes(n * sizeof(T), alignof(T))); }
+
+    void reset() { cur = 0; used = 0; }
+};
+
+// a region's current domain, a prefix of its row in domainStore
+struct Domain {
+    int* vals = nullptr;
+    int sz = 0;
+    int* begin() const { return vals; }
+    int* end() const { return vals + sz; }
+    int size() const { return sz; }
+};
+
+// Packed Colors 
+// search-time region colors at 4 bits each while k <= 15, 8 bits while k <= 255,
+// 16 bits beyond that. The all-ones field means unassigned and reads back as -1.
+int PACKED_COLOR_BITS = 0;  // wider fields than k needs (8 or 16), for the fuzz mode
+
+struct PackedColors {
+    vector<uint8_t> bytes;
+    int bits = 8;
+
+    void init(int n, int k) {
+        bits = max(PACKED_COLOR_BITS, k <= 15 ? 4 : k <= 255 ? 8 : 16);
+        bytes.assign(((size_t)n * bits + 7) / 8, 0xFF);
+    }
+
+    int get(int i) const {
+        if (bits == 4) {
+            int c = (bytes[i >> 1] >> ((i & 1) << 2)) & 0xF;
+            return c == 0xF ? -1 : c;
+        }
+        if (bits == 8) return bytes[i] == 0xFF ? -1 : bytes[i];
+        int c = bytes[2 * i] | (bytes[2 * i + 1] << 8);
+        return c == 0xFFFF ? -1 : c;
+    }
+
+    void set(int i, int c) { // c == -1 clears
+        if (bits == 4) {
+            int sh = (i & 1) << 2;
+            bytes[i >> 1] = (uint8_t)((bytes[i >> 1] & ~(0xF << sh)) | ((c & 0xF) << sh));
+        } else if (bits == 8) {
+            bytes[i] = (uint8_t)c;
+        } else {
+            bytes[2 * i] = (uint8_t)c;
+            bytes[2 * i + 1] = (uint8_t)(c >> 8);
+        }
+    }
+};
+
 //  Global Structures
 int N;  // number of regions
 vector<vector<int>> graphAdj;
-vector<vector<int>> domains;
-vector<int> assignment;
+vector<Domain> domains;
+vector<int> assignment;       // result of the last successful solve
+PackedColors searchColors;    // backtrack() working assignment
+int assignedCount = 0;
+long long searchNodes = 0;    // assignments tried by the last solveWithKColors
+
+// wall-clock budget for the whole search (<= 0: none); searches give up once it passes
+double TIME_LIMIT_SEC = 0;
+chrono::steady_clock::time_point searchDeadline;
+bool searchTimedOut = false;
+
+// the clock is read every 1024 nodes, or every node once a node costs O(N) on big graphs
+bool timeUp() {
+    if (!searchTimedOut && TIME_LIMIT_SEC > 0 && ((searchNodes & 1023) == 0 || N > 4096) &&
+        chrono::steady_clock::now() > searchDeadline)
+        searchTimedOut = true;
+    return searchTimedOut;
+}
 bool USE_AC3 = true;
+bool USE_SMALL_K_KERNELS = true; // route k = 3/4 to the Solver<K> kernels
+Arena solveArena;
+
+// domain rows live in one block of domainRows * domainStride ints, allocated once for
+// the largest k and graph; a smaller one (a k-core while peeling) uses the first N rows.
+// domainTemplate holds the rows 0..stride-1 so a probe resets with one copy
+vector<int> domainStore, domainTemplate;
+int domainStride = 0, domainRows = 0;
+
+void reserveDomains(int kMax) {
+    if (kMax <= domainStride && N <= domainRows) return;
+    domainStride = max(kMax, domainStride);
+    domainRows = max(N, domainRows);
+    domainStore.assign((size_t)domainRows * domainStride, 0);
+    domainTemplate.resize(domainStore.size());
+    for (int i = 0; i < domainRows; ++i)
+        for (int c = 0; c < domainStride; ++c) domainTemplate[(size_t)i * domainStride + c] = c;
+    domains.assign(domainRows, {});
+    for (int i = 0; i < domainRows; ++i) domains[i].vals = domainStore.data() + (size_t)i * domainStride;
+}
+
+// arcs u->v numbered by adjacency slot: arc adjOffset[u] + i is u -> graphAdj[u][i]
+vector<int> adjOffset;  // N + 1 entries
+vector<int> arcFrom;    // arc -> source region
+vector<int> arcRev;     // arc u->v -> arc v->u
+vector<double> edgeWeight; // dom/wdeg weight of edge {u,v}, stored at arc min(u->v, v->u)
+
+unsigned graphVersion = 0; // bumped by buildEdgeIndex(), per-graph caches compare against it
+
+// must be rebuilt whenever graphAdj changes
+void buildEdgeIndex() {
+    ++graphVersion;
+    adjOffset.assign(N + 1, 0);
+    for (int u = 0; u < N; ++u) adjOffset[u + 1] = adjOffset[u] + (int)graphAdj[u].size();
+    int arcs = adjOffset[N];
+    arcFrom.assign(arcs, 0);
+    arcRev.assign(arcs, -1);
+    edgeWeight.assign(arcs, 1.0);
+
+    // bucket arcs by target, then match each against the target's own slots
+    vector<int> inStart(N + 1, 0), inArcs(arcs);
+    for (int u = 0; u < N; ++u)
+        for (int i = 0; i < (int)graphAdj[u].size(); ++i) {
+            arcFrom[adjOffset[u] + i] = u;
+            ++inStart[graphAdj[u][i] + 1];
+        }
+    for (int v = 0; v < N; ++v) inStart[v + 1] += inStart[v];
+    vector<int> fillPos(inStart.begin(), inStart.end() - 1);
+    for (int a = 0; a < arcs; ++a) {
+        int v = graphAdj[arcFrom[a]][a - adjOffset[arcFrom[a]]];
+        inArcs[fillPos[v]++] = a;
+    }
+
+    vector<int> slotTo(N, -1); // slotTo[w] = arc v->w while processing v
+    for (int v = 0; v < N; ++v) {
+        for (int j = 0; j < (int)graphAdj[v].size(); ++j) slotTo[graphAdj[v][j]] = adjOffset[v] + j;
+        for (int t = inStart[v]; t < inStart[v + 1]; ++t) arcRev[inArcs[t]] = slotTo[arcFrom[inArcs[t]]];
+        for (int w : graphAdj[v]) slotTo[w] = -1;
+    }
+}
+
+// Tracing 
+// --trace FILE writes a Chrome trace (chrome://tracing, ui.perfetto.dev) of the run:
+// phases, k probes, SearchTask slices, layout iterations and parallelFor workers.
+// Each thread appends complete events to its own ring of TRACE_RING_EVENTS, oldest
+// overwritten, and only takes the lock to get a ring. Rings are owned globally and
+// handed back when a thread exits, so short-lived pool threads reuse them and a
+// worker slot keeps one timeline row.
+string TRACE_OUTPUT;
+bool TRACING = false;
+size_t TRACE_RING_EVENTS = 1 << 16;
+const chrono::steady_clock::time_point traceEpoch = chrono::steady_clock::now();
+
+struct TraceEvent {
+    const char* name;       // string literal
+    int64_t startNs, durNs;
+    int arg;                // k, iteration or chunk; -1 = none
+};
+
+struct TraceRing {
+    int tid = 0;
+    vector<TraceEvent> events;
+    uint64_t pushed = 0;
+};
+
+mutex traceMutex;
+vector<unique_ptr<TraceRing>> traceRings;
+vector<TraceRing*> freeTraceRings;
+
+struct TraceRingHandle {
+    TraceRing* ring = nullptr;
+    ~TraceRingHandle() {
+        if (!ring) return;
+        lock_guard<mutex> lock(traceMutex);
+        freeTraceRings.push_back(ring);
+    }
+};
+thread_local TraceRingHandle traceHandle;
+
+int64_t traceNow() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - traceEpoch).count();
+}
+
+void traceEvent(const char* name, int64_t startNs, int arg = -1) {
+    int64_t endNs = traceNow();
+    TraceRing*& ring = traceHandle.ring;
+    if (!ring) {
+        lock_guard<mutex> lock(traceMutex);
+        if (!freeTraceRings.empty()) {
+            // lowest free row first, so worker t tends to land on the same row
+            auto it = min_element(freeTraceRings.begin(), freeTraceRings.end(),
+                                  [](TraceRing* a, TraceRing* b) { return a->tid < b->tid; });
+            ring = *it;
+            freeTraceRings.erase(it);
+        } else {
+            traceRings.push_back(make_unique<TraceRing>());
+            ring = traceRings.back().get();
+            ring->tid = (int)traceRings.size() - 1;
+            ring->events.resize(max<size_t>(1, TRACE_RING_EVENTS));
+        }
+    }
+    ring->events[ring->pushed++ % ring->events.size()] = {name, startNs, endNs - startNs, arg};
+}
+
+// one event from construction to destruction
+struct TraceScope {
+    const char* name;
+    int arg;
+    int64_t start;
+    explicit TraceScope(const char* eventName, int eventArg = -1)
+        : name(eventName), arg(eventArg), start(TRACING ? traceNow() : 0) {}
+    ~TraceScope() {
+        if (TRACING) traceEvent(name, start, arg);
+    }
+};
+
+// Phase Profiling 
+// --perf wraps each phase (input, bounds, AC-3 and search per k, counting, export) in
+// one perf_event_open group: cycles, instructions, cache misses and branch misses of
+// this thread in user space. The group is scheduled as a unit, so the four counts
+// cover the same interval. Where the counters can't be opened (not Linux, no PMU in a
+// VM, perf_event_paranoid) phases still get wall times. Phases do not nest. With
+// --trace every phase is also a trace event.
+bool PERF_COUNTERS = false;
+
+struct PhaseRecord {
+    string phase;
+    int k;                  // probe k, -1 outside the search
+    double ms;
+    bool counted;           // counters valid
+    uint64_t cycles, instructions, cacheMisses, branchMisses;
+};
+
+struct PhaseProfiler {
+    static constexpr int EVENTS = 4;
+    int fds[EVENTS] = {-1, -1, -1, -1};
+    bool tried = false, opened = false;
+    string unavailable;     // why the counters are off
+    vector<PhaseRecord> records;
+    const char* phase = "";
+    int k = -1;
+    chrono::steady_clock::time_point start;
+    int64_t traceStart = 0;
+
+    void open() {
+        tried = true;
+#ifdef __linux__
+        const uint64_t configs[EVENTS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                          PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        for (int i = 0; i < EVENTS; ++i) {
+            perf_event_attr attr{};
+            attr.size = sizeof attr;
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.disabled = i == 0; // members follow the leader
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, i ? fds[0] : -1, 0);
+            if (fds[i] < 0) {
+                unavailable = string("perf_event_open: ") + strerror(errno);
+                closeAll();
+                return;
+            }
+        }
+        opened = true;
+#else
+        unavailable = "perf_event_open needs Linux";
+#endif
+    }
+
+    void closeAll() {
+#ifdef __linux__
+        for (int& fd : fds)
+            if (fd >= 0) { close(fd); fd = -1; }
+#endif
+        opened = false;
+    }
+
+    ~PhaseProfiler() { closeAll(); }
+
+    void begin(const char* name, int probeK = -1) {
+        if (TRACING) traceStart = traceNow();
+        if (!PERF_COUNTERS) {
+            phase = name;
+            k = probeK;
+            return;
+        }
+        if (!tried) open();
+        phase = name;
+        k = probeK;
+        start = chrono::steady_clock::now();
+#ifdef __linux__
+        if (opened) {
+            ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    void end() {
+        if (TRACING) traceEvent(phase, traceStart, k);
+        if (!PERF_COUNTERS) return;
+        PhaseRecord r{phase, k, 0, false, 0, 0, 0, 0};
+#ifdef __linux__
+        if (opened) {
+            ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            uint64_t buf[1 + EVENTS]; // PERF_FORMAT_GROUP: nr, then one value per event
+            if (read(fds[0], buf, sizeof buf) == (ssize_t)sizeof buf && buf[0] == EVENTS) {
+                r.counted = true;
+                r.cycles = buf[1];
+                r.instructions = buf[2];
+                r.cacheMisses = buf[3];
+                r.branchMisses = buf[4];
+            }
+        }
+#endif
+        r.ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        records.push_back(r);
+    }
+};
+PhaseProfiler profiler;
 
 // Random Graph Generator 
-void generateRandomGraph(int nodes, int edgeProbabilityPercent = 40) {
+void generateRandomGraph(int nodes, int edgeProbabilityPercent = 40,
+                         unsigned seed = (unsigned)chrono::system_clock::now().time_since_epoch().count()) {
     N = nodes;
     graphAdj.assign(N, {});
     assignment.assign(N, -1);
 
-    unsigned seed = (unsigned)chrono::system_clock::now().time_since_epoch().count();
     mt19937 rng(seed);
     uniform_int_distribution<int> dist(1, 100);
 
@@ -33,37 +390,126 @@ void generateRandomGraph(int nodes, int edgeProbabilityPercent = 40) {
             }
         }
     }
+    buildEdgeIndex();
+}
+
+// Graph Input 
+// EDGES: "u v" per line, 0-based ids up to INT_MAX - 2, N = largest id + 1.
+// DIMACS: "p edge n m" then "e u v" lines, 1-based ids up to the declared n < INT_MAX.
+// Lines starting with '#', 'c' or '%' are comments; self loops and repeated edges are dropped.
+// Ids out of range fail the load rather than wrap around in the int casts, and so does
+// a graph too big to allocate (a huge id in a small file still means N regions).
+enum class InputFormat { EDGES, DIMACS };
+
+bool loadGraph(const string& path, InputFormat format) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    string text;
+    char chunk[1 << 16];
+    size_t got;
+    while ((got = fread(chunk, 1, sizeof chunk, f)) > 0) text.append(chunk, got);
+    fclose(f);
+
+    vector<pair<int,int>> edges;
+    int n = 0;
+    const char* p = text.c_str();
+    const char* end = p + text.size();
+    while (p < end) {
+        const char* eol = (const char*)memchr(p, '\n', end - p);
+        if (!eol) eol = end;
+        while (p < eol && (*p == ' ' || *p == '\t')) ++p;
+        bool comment = p == eol || *p == '#' || *p == '%' || *p == '\r' ||
+                       (format == InputFormat::DIMACS && *p == 'c');
+        if (!comment) {
+            char* q;
+            if (format == InputFormat::DIMACS) {
+                if (*p == 'p') { // p edge n m
+                    const char* num = p + 1;
+                    while (num < eol && !(*num >= '0' && *num <= '9')) ++num;
+                    long declared = strtol(num, nullptr, 10);
+                    if (declared > INT_MAX - 1) return false;
+                    n = max(n, (int)declared);
+                } else if (*p == 'e') {
+                    long u = strtol(p + 1, &q, 10), v = strtol(q, nullptr, 10);
+                    if (u < 1 || v < 1 || u > n || v > n) return false;
+                    edges.push_back({(int)u - 1, (int)v - 1});
+                }
+            } else {
+                long u = strtol(p, &q, 10);
+                if (q == p) return false;
+                const char* r = q;
+                long v = strtol(r, &q, 10);
+                if (q == r || u < 0 || v < 0 || u > INT_MAX - 2 || v > INT_MAX - 2) return false;
+                edges.push_back({(int)u, (int)v});
+            }
+        }
+        p = eol + 1;
+    }
+    if (edges.size() > (size_t)INT_MAX / 2) return false; // arcs are numbered by int
+
+    for (auto& e : edges) n = max(n, max(e.first, e.second) + 1);
+    try {
+        N = n;
+        graphAdj.assign(N, {});
+        for (auto& e : edges) {
+            if (e.first == e.second) continue;
+            graphAdj[e.first].push_back(e.second);
+            graphAdj[e.second].push_back(e.first);
+        }
+        for (auto& nbs : graphAdj) {
+            sort(nbs.begin(), nbs.end());
+            nbs.erase(unique(nbs.begin(), nbs.end()), nbs.end());
+        }
+        assignment.assign(N, -1);
+        buildEdgeIndex();
+    } catch (const bad_alloc&) {
+        N = 0;
+        vector<vector<int>>().swap(graphAdj);
+        assignment.clear();
+        return false;
+    }
+    return true;
 }
 
 // revise -> -1 wiped, 0 nochange, 1 reduced 
+// Di is compacted in place (Xi != Xj), so no scratch buffer is needed
 int revise(int Xi, int Xj) {
-    vector<int> newDi;
-    bool reduced = false;
+    Domain& Di = domains[Xi];
+    const Domain& Dj = domains[Xj];
+    int kept = 0;
 
-    for (int a : domains[Xi]) {
+    for (int idx = 0; idx < Di.sz; ++idx) {
+        int a = Di.vals[idx];
         bool supported = false;
-        for (int b : domains[Xj]) {
+        for (int b : Dj) {
             if (a != b) { supported = true; break; } // adjacency constraint
         }
-        if (supported) newDi.push_back(a);
-        else reduced = true;
+        if (supported) Di.vals[kept++] = a;
     }
 
-    if (newDi.empty()) return -1;          // domain wipe-out
-    if (!reduced) return 0;                // unchanged
-    domains[Xi].swap(newDi);
+    if (kept == 0) return -1;              // domain wipe-out
+    if (kept == Di.sz) return 0;           // unchanged
+    Di.sz = kept;
     return 1;                              // reduced
 }
 
 //  AC-3 
+// worklist is a ring of arc ids in the solve arena; an arc is queued at most once
 bool AC3() {
-    queue<pair<int,int>> q;
-    for (int i = 0; i < N; ++i)
-        for (int j : graphAdj[i])
-            q.push({i, j});
+    int arcs = adjOffset[N];
+    if (arcs == 0) return true;
+    int* q = solveArena.alloc<int>(arcs);
+    char* queued = solveArena.alloc<char>(arcs);
+    int head = 0, count = arcs;
+    for (int a = 0; a < arcs; ++a) { q[a] = a; queued[a] = 1; }
 
-    while (!q.empty()) {
-        auto [Xi, Xj] = q.front(); q.pop();
+    while (count > 0) {
+        int arc = q[head];
+        head = (head + 1 == arcs) ? 0 : head + 1;
+        --count;
+        queued[arc] = 0;
+        int Xi = arcFrom[arc];
+        int Xj = graphAdj[Xi][arc - adjOffset[Xi]];
         int status = revise(Xi, Xj);
         if (status == -1) {
             // domain wiped out -> unsatisfiable under current domains
@@ -71,9 +517,14 @@ bool AC3() {
         }
         if (status == 1) { // reduced
             // enqueue (Xk, Xi) for all neighbors Xk except Xj
-            for (int Xk : graphAdj[Xi]) {
-                if (Xk == Xj) continue;
-                q.push({Xk, Xi});
+            for (int a = adjOffset[Xi]; a < adjOffset[Xi + 1]; ++a) {
+                int back = arcRev[a]; // Xk -> Xi
+                if (arcFrom[back] == Xj || queued[back]) continue;
+                int tail = head + count;
+                if (tail >= arcs) tail -= arcs;
+                q[tail] = back;
+                queued[back] = 1;
+                ++count;
             }
         }
         // if status == 0 nothing to do
@@ -82,10 +533,94 @@ bool AC3() {
 }
 
 
+// Core Decomposition 
+// Batagelj-Zaversnik bucket peeling in O(N + E): regions are removed in order of
+// smallest remaining degree. core[v] is the largest c such that v lies in a subgraph
+// of minimum degree c (the c-core); the degeneracy d is the largest core number.
+// Smallest-last is the reverse of the removal order: every region has at most d
+// neighbors before it, so greedy along it uses at most d + 1 colors.
+struct CoreDecomposition {
+    int degeneracy = 0;
+    vector<int> core;       // core number per region
+    vector<int> removal;    // peeling order, core numbers non-decreasing
+
+    vector<int> smallestLast() const { return vector<int>(removal.rbegin(), removal.rend()); }
+};
+
+CoreDecomposition coreDecomposition() {
+    CoreDecomposition cd;
+    vector<int>& deg = cd.core; // remaining degree, final value is the core number
+    deg.resize(N);
+    int maxDeg = 0;
+    for (int v = 0; v < N; ++v) {
+        deg[v] = (int)graphAdj[v].size();
+        maxDeg = max(maxDeg, deg[v]);
+    }
+    // vert sorted by degree, bin[d] = first slot of degree d, pos[v] = slot of v
+    vector<int> bin(maxDeg + 2, 0), vert(N), pos(N);
+    for (int v = 0; v < N; ++v) ++bin[deg[v] + 1];
+    for (int d = 0; d <= maxDeg; ++d) bin[d + 1] += bin[d];
+    for (int v = 0; v < N; ++v) {
+        pos[v] = bin[deg[v]]++;
+        vert[pos[v]] = v;
+    }
+    for (int d = maxDeg; d > 0; --d) bin[d] = bin[d - 1];
+    bin[0] = 0;
+
+    for (int i = 0; i < N; ++i) {
+        int v = vert[i];
+        for (int u : graphAdj[v]) {
+            if (deg[u] <= deg[v]) continue;
+            // move u to the front of its bucket, then shrink it into the bucket below
+            int du = deg[u], pu = pos[u], pw = bin[du], w = vert[pw];
+            if (u != w) {
+                swap(vert[pu], vert[pw]);
+                pos[u] = pw;
+                pos[w] = pu;
+            }
+            ++bin[du];
+            --deg[u];
+        }
+        cd.degeneracy = max(cd.degeneracy, deg[v]);
+    }
+    cd.removal = move(vert);
+    return cd;
+}
+
+// each region's neighbors that come before it in smallest-last order: at most d per
+// region and every edge listed once, at its later end. Lists are sorted, so adjacency
+// is a binary search over at most d ids, even next to hubs.
+struct EarlierNeighbors {
+    vector<int> order, pos, start, list;
+
+    explicit EarlierNeighbors(const CoreDecomposition& cd) : order(cd.smallestLast()), pos(N), start(N + 1, 0) {
+        for (int i = 0; i < N; ++i) pos[order[i]] = i;
+        for (int v = 0; v < N; ++v) {
+            start[v + 1] = start[v];
+            for (int u : graphAdj[v])
+                if (pos[u] < pos[v]) ++start[v + 1];
+        }
+        list.resize(start[N]);
+        for (int v = 0, e = 0; v < N; ++v) {
+            for (int u : graphAdj[v])
+                if (pos[u] < pos[v]) list[e++] = u;
+            sort(list.begin() + start[v], list.begin() + e);
+        }
+    }
+
+    const int* begin(int v) const { return list.data() + start[v]; }
+    const int* end(int v) const { return list.data() + start[v + 1]; }
+    int size(int v) const { return start[v + 1] - start[v]; }
+    bool adjacent(int x, int y) const {
+        if (pos[x] > pos[y]) swap(x, y);
+        return binary_search(begin(y), end(y), x);
+    }
+};
+
 // CSP Logic 
 bool isConsistent(int var, int value) {
     for (int nb : graphAdj[var])
-        if (assignment[nb] == value)
+        if (searchColors.get(nb) == value)
             return false;
     return true;
 }
@@ -93,7 +628,7 @@ bool isConsistent(int var, int value) {
 int selectMRV() {
     int best = -1, bestSize = INT_MAX;
     for (int i = 0; i < N; ++i) {
-        if (assignment[i] == -1) {
+        if (searchColors.get(i) == -1) {
             int sz = (int)domains[i].size();
             if (sz < bestSize) {
                 bestSize = sz;
@@ -104,33 +639,288 @@ int selectMRV() {
     return best;
 }
 
+// Search Heuristics 
+// value order - NATURAL: domain order, LCV: least-constraining value first (fewest
+// unassigned neighbors lose it), POPULAR: most-used color first, PHASE: the color
+// the region last took (kept across probes) first
+enum class ValueOrder { NATURAL, LCV, POPULAR, PHASE };
+ValueOrder VALUE_ORDER = ValueOrder::NATURAL;
+
+// variable order - MRV: smallest static domain, DOM_WDEG: smallest live domain over
+// weighted degree, where an edge's weight grows each time it empties a domain.
+// WDEG_DECAY < 1 makes later conflicts count more (weights are rescaled as needed).
+// DEGENERACY: fixed smallest-last order, region i of it at depth i, O(1) per node.
+enum class VarOrder { MRV, DOM_WDEG, DEGENERACY };
+VarOrder VAR_ORDER = VarOrder::MRV;
+double WDEG_DECAY = 1.0;
+
+int searchK = 0;
+vector<int> nbColorCount;           // nbColorCount[v*k + c] = assigned neighbors of v with color c
+vector<int> colorUseCount;          // regions currently holding color c
+vector<int> savedPhase;             // last color each region took
+vector<pair<int,int>> orderBuf;     // (key, value) scratch, k entries per search depth
+vector<int> liveCount;              // domain values of v not held by an assigned neighbor
+vector<double> wdeg;                // summed weight of v's edges to unassigned neighbors
+double wdegBump = 1.0;
+int wdegRescales = 0;               // times edgeWeight was scaled by 1e-100
+vector<int> staticOrder;            // DEGENERACY: smallest-last order
+
+bool trackColorCounts() { return VALUE_ORDER != ValueOrder::NATURAL || VAR_ORDER == VarOrder::DOM_WDEG; }
+
+bool inDomain(int v, int val) {
+    return domains[v].size() == searchK ||
+           find(domains[v].begin(), domains[v].end(), val) != domains[v].end();
+}
+
+void initSearchHeuristics(int k) {
+    searchK = k;
+    if ((int)savedPhase.size() != N) savedPhase.assign(N, -1);
+    if (VAR_ORDER == VarOrder::DEGENERACY) staticOrder = coreDecomposition().smallestLast();
+    if (!trackColorCounts()) return;
+    nbColorCount.assign((size_t)N * k, 0);
+    colorUseCount.assign(k, 0);
+    orderBuf.resize((size_t)N * k);
+    if (VAR_ORDER != VarOrder::DOM_WDEG) return;
+    // edge weights carry over between probes, wdeg is rebuilt from them
+    liveCount.assign(N, 0);
+    wdeg.assign(N, 0.0);
+    for (int v = 0; v < N; ++v) {
+        liveCount[v] = domains[v].size();
+        for (int a = adjOffset[v]; a < adjOffset[v + 1]; ++a) wdeg[v] += edgeWeight[min(a, arcRev[a])];
+    }
+}
+
+void assignColor(int var, int val) {
+    ++searchNodes;
+    searchColors.set(var, val);
+    ++assignedCount;
+    savedPhase[var] = val;
+    if (!trackColorCounts()) return;
+    ++colorUseCount[val];
+    bool wd = VAR_ORDER == VarOrder::DOM_WDEG;
+    for (int a = adjOffset[var]; a < adjOffset[var + 1]; ++a) {
+        int nb = graphAdj[var][a - adjOffset[var]];
+        if (nbColorCount[(size_t)nb * searchK + val]++ == 0 && wd && inDomain(nb, val)) --liveCount[nb];
+        if (wd) wdeg[nb] -= edgeWeight[min(a, arcRev[a])];
+    }
+}
+
+void unassignColor(int var, int val) {
+    searchColors.set(var, -1);
+    --assignedCount;
+    if (!trackColorCounts()) return;
+    --colorUseCount[val];
+    bool wd = VAR_ORDER == VarOrder::DOM_WDEG;
+    for (int a = adjOffset[var]; a < adjOffset[var + 1]; ++a) {
+        int nb = graphAdj[var][a - adjOffset[var]];
+        if (--nbColorCount[(size_t)nb * searchK + val] == 0 && wd && inDomain(nb, val)) ++liveCount[nb];
+        if (wd) wdeg[nb] += edgeWeight[min(a, arcRev[a])];
+    }
+}
+
+// var's domain was emptied: bump every edge to an assigned neighbor holding one of its values
+void bumpConflict(int var) {
+    for (int a = adjOffset[var]; a < adjOffset[var + 1]; ++a) {
+        int nb = graphAdj[var][a - adjOffset[var]];
+        int c = searchColors.get(nb);
+        if (c == -1 || !inDomain(var, c)) continue;
+        edgeWeight[min(a, arcRev[a])] += wdegBump;
+        wdeg[nb] += wdegBump; // var is unassigned, so the edge counts for nb
+    }
+    if (WDEG_DECAY < 1.0) {
+        wdegBump /= WDEG_DECAY;
+        if (wdegBump > 1e100) { // rescale before overflow
+            for (double& w : edgeWeight) w *= 1e-100;
+            for (double& w : wdeg) w *= 1e-100;
+            wdegBump *= 1e-100;
+            ++wdegRescales;
+        }
+    }
+}
+
+int selectDomWdeg() {
+    int best = -1;
+    double bestScore = 0;
+    for (int i = 0; i < N; ++i) {
+        if (searchColors.get(i) != -1) continue;
+        if (liveCount[i] == 0) return i; // wiped out, fail here
+        double score = wdeg[i] > 0 ? liveCount[i] / wdeg[i] : 1e300;
+        if (best == -1 || score < bestScore) {
+            bestScore = score;
+            best = i;
+        }
+    }
+    return best;
+}
+
+int selectVar() {
+    // backtrack() assigns and undoes in stack order, so depth == assignedCount
+    if (VAR_ORDER == VarOrder::DEGENERACY) return staticOrder[assignedCount];
+    return VAR_ORDER == VarOrder::DOM_WDEG ? selectDomWdeg() : selectMRV();
+}
+
+// consistent values of var in try order -> count written to out
+int orderValues(int var, pair<int,int>* out) {
+    int n = 0;
+    for (int val : domains[var]) {
+        if (nbColorCount[(size_t)var * searchK + val] != 0) continue; // inconsistent
+        int key = 0;
+        if (VALUE_ORDER == ValueOrder::LCV) {
+            for (int nb : graphAdj[var]) {
+                if (searchColors.get(nb) != -1) continue;
+                if (nbColorCount[(size_t)nb * searchK + val] != 0) continue; // already lost it
+                if (inDomain(nb, val)) ++key;
+            }
+        } else if (VALUE_ORDER == ValueOrder::POPULAR) {
+            key = -colorUseCount[val];
+        } else if (VALUE_ORDER == ValueOrder::PHASE) {
+            key = (val == savedPhase[var]) ? 0 : 1;
+        }
+        out[n++] = {key, val};
+    }
+    sort(out, out + n); // ties by color index
+    return n;
+}
+
 bool backtrack() {
-    bool complete = all_of(assignment.begin(), assignment.end(), [](int x){ return x != -1; });
-    if (complete) return true;
+    if (assignedCount == N) return true; // complete
+    if (timeUp()) return false;
 
-    int var = selectMRV();
+    int var = selectVar();
     if (var == -1) return false; // no variable found but not complete -> failure
 
+    if (trackColorCounts()) {
+        pair<int,int>* vals = orderBuf.data() + (size_t)assignedCount * searchK;
+        int n = orderValues(var, vals);
+        if (n == 0 && VAR_ORDER == VarOrder::DOM_WDEG) bumpConflict(var);
+        for (int i = 0; i < n; ++i) {
+            int val = vals[i].second;
+            assignColor(var, val);
+            if (backtrack()) return true;
+            unassignColor(var, val);
+        }
+        return false;
+    }
+
     for (int val : domains[var]) {
         if (!isConsistent(var, val)) continue;
-        assignment[var] = val;
+        assignColor(var, val);
         if (backtrack()) return true;
-        assignment[var] = -1;
+        unassignColor(var, val);
     }
     return false;
 }
 
+// Small-k Kernels 
+// specialized search for k = 3/4. A region's domain and the colors held by its
+// assigned neighbors are the two nibbles of one byte, the latter kept in sync with
+// per-color neighbor counts, so the candidate set is a single byte op and value
+// iteration is unrolled over the K bits. Counts are as narrow as the max degree
+// allows and colors are nibbles: 5.5 bytes per region at K = 4 on map-like graphs.
+// Picks the unassigned region with the fewest candidates (dynamic MRV).
+template <int K, class Count>
+struct Solver {
+    static_assert(K >= 1 && K <= 4, "domain must fit in a nibble");
+    static constexpr uint8_t FULL = (uint8_t)((1u << K) - 1);
+
+    vector<uint8_t> masks;      // low nibble: colors left after AC-3, high: held by an assigned neighbor
+    vector<Count> nbCount;      // nbCount[v*K + c] = assigned neighbors of v with color c
+    vector<uint8_t> color;      // two regions per byte, 0xF = unassigned
+
+    uint8_t candidates(int v) const { return masks[v] & ~(masks[v] >> 4) & FULL; }
+    int colorOf(int v) const { return (color[v >> 1] >> ((v & 1) << 2)) & 0xF; }
+    void setColor(int v, int c) { // c == 0xF clears
+        int sh = (v & 1) << 2;
+        color[v >> 1] = (uint8_t)((color[v >> 1] & ~(0xF << sh)) | (c << sh));
+    }
+
+    void assign(int v, int c) {
+        ++searchNodes;
+        setColor(v, c);
+        for (int nb : graphAdj[v])
+            if (nbCount[(size_t)nb * K + c]++ == 0) masks[nb] |= (uint8_t)(0x10u << c);
+    }
+
+    void unassign(int v) {
+        int c = colorOf(v);
+        setColor(v, 0xF);
+        for (int nb : graphAdj[v])
+            if (--nbCount[(size_t)nb * K + c] == 0) masks[nb] &= (uint8_t)~(0x10u << c);
+    }
+
+    int select() const {
+        int best = -1, bestSize = K + 1;
+        for (int i = 0; i < N; ++i) {
+            if (colorOf(i) != 0xF) continue;
+            int sz = __builtin_popcount(candidates(i));
+            if (sz < bestSize) {
+                bestSize = sz;
+                best = i;
+                if (sz == 0) break; // dead end, fail right away
+            }
+        }
+        return best;
+    }
+
+    bool tryColor(int v, int c, int assigned) {
+        assign(v, c);
+        if (search(assigned + 1)) return true;
+        unassign(v);
+        return false;
+    }
+
+    template <size_t... C>
+    bool tryColors(int v, uint8_t freeMask, int assigned, index_sequence<C...>) {
+        return (((freeMask >> C) & 1 && tryColor(v, (int)C, assigned)) || ...);
+    }
+
+    bool search(int assigned) {
+        if (assigned == N) return true;
+        if (timeUp()) return false;
+        int v = select();
+        return tryColors(v, candidates(v), assigned, make_index_sequence<K>{});
+    }
+
+    // searches from the current domains, fills assignment on success
+    bool run() {
+        masks.assign(N, 0);
+        for (int i = 0; i < N; ++i)
+            for (int c : domains[i]) masks[i] |= (uint8_t)(1u << c);
+        nbCount.assign((size_t)N * K, 0);
+        color.assign((N + 1) / 2, 0xFF);
+
+        if (!search(0)) return false;
+        for (int i = 0; i < N; ++i) assignment[i] = colorOf(i);
+        return true;
+    }
+};
+
+// the narrowest neighbor counter that holds the max degree
+int KERNEL_COUNT_BYTES = 0; // wider counters than the degree needs (2 or 4), for the fuzz mode
+
+template <int K>
+bool runKernel() {
+    size_t maxDeg = 0;
+    for (const auto& nbs : graphAdj) maxDeg = max(maxDeg, nbs.size());
+    if (maxDeg <= UINT8_MAX && KERNEL_COUNT_BYTES <= 1) return Solver<K, uint8_t>().run();
+    if (maxDeg <= UINT16_MAX && KERNEL_COUNT_BYTES <= 2) return Solver<K, uint16_t>().run();
+    return Solver<K, uint32_t>().run();
+}
+
 // Solve for minimum colors 
 bool solveWithKColors(int k, bool verbose = true) {
-    // init domains 0..k-1
-    domains.assign(N, {});
-    for (int i = 0; i < N; ++i) {
-        for (int c = 0; c < k; ++c) domains[i].push_back(c);
-    }
+    // init domains 0..k-1: bulk copy of the template, other scratch comes from the arena
+    solveArena.reset();
+    searchNodes = 0;
+    reserveDomains(k);
+    memcpy(domainStore.data(), domainTemplate.data(), (size_t)N * domainStride * sizeof(int));
+    for (int i = 0; i < N; ++i) domains[i].sz = k;
 
     if (verbose) cout << "  Running AC-3 preprocessing... ";
     if (USE_AC3) {
+        profiler.begin("ac3", k);
         bool ok = AC3();
+        profiler.end();
         if (verbose) cout << (ok ? "OK\n" : "FAILED (inconsistent)\n");
         if (!ok) return false;
     } else {
@@ -138,143 +928,2765 @@ bool solveWithKColors(int k, bool verbose = true) {
     }
 
     fill(assignment.begin(), assignment.end(), -1);
-    bool res = backtrack();
+    bool res;
+    // the kernels implement MRV with values in natural order only
+    bool kernel = USE_SMALL_K_KERNELS && VALUE_ORDER == ValueOrder::NATURAL && VAR_ORDER == VarOrder::MRV;
+    profiler.begin("search", k);
+    if (kernel && k == 3) res = runKernel<3>();
+    else if (kernel && k == 4) res = runKernel<4>();
+    else {
+        searchColors.init(N, k);
+        assignedCount = 0;
+        initSearchHeuristics(k);
+        res = backtrack();
+        if (res) for (int i = 0; i < N; ++i) assignment[i] = searchColors.get(i);
+    }
+    profiler.end();
     if (verbose) cout << (res ? "  Backtracking found a solution.\n" : "  Backtracking found NO solution.\n");
     return res;
 }
 
-// Graph Visualization 
-struct Coord { int x,y; };
-
-vector<Coord> generateCoordinates(int width, int height) {
-    vector<Coord> coords(N);
-    mt19937 rng((unsigned)chrono::system_clock::now().time_since_epoch().count());
-    uniform_int_distribution<int> distX(2, max(2, width - 6));
-    uniform_int_distribution<int> distY(0, max(0, height - 1));
+// Chordal Graphs 
+// maximum cardinality search visits next the unvisited region with the most visited
+// neighbors (buckets by that count, O(N + E)). The graph is chordal iff the reverse
+// visit order is a perfect elimination order: each region's earlier-visited neighbors
+// form a clique. It suffices that they all neighbor the latest-visited one among them
+// (its parent), and those requests are checked in one pass per parent. Greedy in visit
+// order then colors each region against a clique, so it uses exactly omega = chi colors.
+struct ChordalResult {
+    bool chordal = false;
+    int chi = 0;
+    vector<int> colors;     // optimal coloring when chordal
+    vector<int> clique;     // a maximum clique when chordal
+};
 
-    set<pair<int,int>> used;
+ChordalResult chordalColoring() {
+    ChordalResult r;
+    // buckets of unvisited regions by visited-neighbor count, doubly linked
+    vector<int> weight(N, 0), head(N + 1, -1), next(N, -1), prev(N, -1), pos(N, -1), order;
+    order.reserve(N);
+    auto link = [&](int v) {
+        int w = weight[v];
+        prev[v] = -1;
+        next[v] = head[w];
+        if (head[w] != -1) prev[head[w]] = v;
+        head[w] = v;
+    };
+    auto unlink = [&](int v) {
+        if (prev[v] != -1) next[prev[v]] = next[v];
+        else head[weight[v]] = next[v];
+        if (next[v] != -1) prev[next[v]] = prev[v];
+    };
+    for (int v = N - 1; v >= 0; --v) link(v);
+    int top = 0;
     for (int i = 0; i < N; ++i) {
-        int x, y;
-        int attempts = 0;
-        do {
-            x = distX(rng);
-            y = distY(rng);
-            attempts++;
-            if (attempts > 500) break; // give up if space is tight
-        } while (used.count({x,y}) > 0);
-        coords[i] = {x,y};
-        used.insert({x,y});
+        while (top > 0 && head[top] == -1) --top;
+        int v = head[top];
+        unlink(v);
+        pos[v] = i;
+        order.push_back(v);
+        for (int u : graphAdj[v]) {
+            if (pos[u] != -1) continue;
+            unlink(u);
+            ++weight[u];
+            link(u);
+            top = max(top, weight[u]);
+        }
     }
-    return coords;
-}
 
-void printAdjacencyList() {
-    cout << "\nAdjacency list: \n";
-    for (int i = 0; i < N; ++i) {
-        cout << "Region " << i << ": ";
-        for (int nb : graphAdj[i]) cout << nb << " ";
-        cout << '\n';
+    // parent = latest-visited earlier neighbor; every other earlier neighbor must touch it
+    vector<int> parent(N, -1), reqStart(N + 1, 0), reqs;
+    for (int v = 0; v < N; ++v)
+        for (int u : graphAdj[v])
+            if (pos[u] < pos[v] && (parent[v] == -1 || pos[u] > pos[parent[v]])) parent[v] = u;
+    for (int v = 0; v < N; ++v)
+        if (parent[v] != -1) reqStart[parent[v] + 1] += (int)weight[v] - 1;
+    for (int v = 0; v < N; ++v) reqStart[v + 1] += reqStart[v];
+    reqs.resize(reqStart[N]);
+    vector<int> slot(reqStart.begin(), reqStart.end() - 1);
+    for (int v = 0; v < N; ++v)
+        for (int u : graphAdj[v])
+            if (pos[u] < pos[v] && u != parent[v]) reqs[slot[parent[v]]++] = u;
+    vector<int> mark(N, -1);
+    for (int p = 0; p < N; ++p) {
+        if (reqStart[p] == reqStart[p + 1]) continue;
+        for (int u : graphAdj[p]) mark[u] = p;
+        for (int i = reqStart[p]; i < reqStart[p + 1]; ++i)
+            if (mark[reqs[i]] != p) return r;
     }
+
+    r.chordal = true;
+    r.colors.assign(N, -1);
+    int best = -1;
+    for (int v : order) {
+        for (int u : graphAdj[v])
+            if (r.colors[u] != -1) mark[r.colors[u]] = N + v; // earlier neighbors: a clique
+        int c = 0;
+        while (mark[c] == N + v) ++c;
+        r.colors[v] = c;
+        if (c + 1 > r.chi) {
+            r.chi = c + 1;
+            best = v;
+        }
+    }
+    if (best != -1) {
+        r.clique.push_back(best);
+        for (int u : graphAdj[best])
+            if (pos[u] < pos[best]) r.clique.push_back(u);
+    }
+    return r;
 }
 
-void printGraphDiagram() {
-    cout << "\nGraph diagram: \n\n";
+// Fast Paths 
+// O(1) answers for probes that need no search, from facts gathered once per graph in
+// O(N + E): no edges (any k >= 1), k = 1 with edges, bipartite graphs such as trees,
+// forests and even cycles (2-coloring by BFS, and an odd cycle rules out k = 2), max
+// degree < k, which covers paths, cycles with k >= 3 and complete graphs with k >= N
+// (greedy in index order never runs out), and a complete component on more than k
+// regions. Chordal graphs never get here: main() colors them optimally up front.
+// Returns false when none applies; a solved probe fills assignment in O(N + E).
+bool USE_FAST_PATHS = true;
+const char* fastPathReason = "";    // which case answered the last probe
 
-    const int canvasRows = 20;
-    const int canvasCols = 60;
-    vector<string> canvas(canvasRows, string(canvasCols, ' '));
+struct FastPathFacts {
+    unsigned version = 0;           // graphVersion the facts belong to
+    bool hasEdges = false, bipartite = false;
+    int maxDeg = 0;
+    int largestComplete = 0;        // regions in the largest complete component
+    vector<int> twoColoring;        // BFS coloring, proper when bipartite
+};
+FastPathFacts fastPathFacts;
 
-    // Generate random positions for nodes (avoiding overlap)
-    struct Pos { int r, c; };
-    vector<Pos> pos(N);
-    set<pair<int,int>> used;
-    mt19937 rng((unsigned)chrono::system_clock::now().time_since_epoch().count());
-    uniform_int_distribution<int> distR(0, canvasRows-1);
-    uniform_int_distribution<int> distC(0, canvasCols-3); // node width
+void gatherFastPathFacts() {
+    FastPathFacts& f = fastPathFacts;
+    f.version = graphVersion;
+    f.maxDeg = 0;
+    for (int v = 0; v < N; ++v) f.maxDeg = max(f.maxDeg, (int)graphAdj[v].size());
+    f.hasEdges = f.maxDeg > 0;
 
-    for (int i = 0; i < N; ++i) {
-        int r, c;
-        int attempts = 0;
-        do {
-            r = distR(rng);
-            c = distC(rng);
-            attempts++;
-            if (attempts > 500) break; // give up
-        } while (used.count({r,c}) > 0);
-        pos[i] = {r,c};
-        used.insert({r,c});
+    // BFS 2-coloring; a component of `tail` regions with tail * (tail - 1) arc slots is complete
+    vector<int>& color = f.twoColoring;
+    color.assign(N, -1);
+    vector<int> queue(N);
+    f.bipartite = true;
+    f.largestComplete = 0;
+    for (int s = 0; s < N; ++s) {
+        if (color[s] != -1) continue;
+        int head = 0, tail = 0;
+        long long degSum = 0;
+        color[s] = 0;
+        queue[tail++] = s;
+        while (head < tail) {
+            int u = queue[head++];
+            degSum += graphAdj[u].size();
+            for (int v : graphAdj[u]) {
+                if (color[v] == -1) {
+                    color[v] = color[u] ^ 1;
+                    queue[tail++] = v;
+                } else if (color[v] == color[u]) {
+                    f.bipartite = false;
+                }
+            }
+        }
+        if (degSum == (long long)tail * (tail - 1)) f.largestComplete = max(f.largestComplete, tail);
     }
+}
 
-    // Draw edges
-    auto setCharSafe = [&](int r, int c, char ch){
-        if (r<0 || r>=canvasRows || c<0 || c>=canvasCols) return;
-        char cur = canvas[r][c];
-        if (cur=='(' || cur==')' || (cur>='0' && cur<='9')) return;
-        canvas[r][c] = ch;
+bool fastPathProbe(int k, bool& solvable) {
+    if (fastPathFacts.version != graphVersion) gatherFastPathFacts();
+    const FastPathFacts& f = fastPathFacts;
+    auto solved = [&](const char* why) {
+        fastPathReason = why;
+        solvable = true;
+        return true;
     };
+    auto unsolvable = [&](const char* why) {
+        fastPathReason = why;
+        solvable = false;
+        return true;
+    };
+
+    if (k <= 0) return N == 0 ? solved("empty graph") : unsolvable("k < 1");
+    if (!f.hasEdges) {
+        fill(assignment.begin(), assignment.end(), 0);
+        return solved("no edges");
+    }
+    if (k == 1) return unsolvable("k = 1 with edges");
+    if (f.largestComplete > k) return unsolvable("complete component larger than k");
+    if (f.bipartite) {
+        assignment = f.twoColoring;
+        return solved("bipartite");
+    }
+    if (k == 2) return unsolvable("odd cycle");
+
+    if (f.maxDeg < k) {
+        vector<char> used(f.maxDeg + 1);
+        for (int v = 0; v < N; ++v) {
+            fill(used.begin(), used.end(), 0);
+            for (int nb : graphAdj[v])
+                if (nb < v) used[assignment[nb]] = 1;
+            int c = 0;
+            while (used[c]) ++c;
+            assignment[v] = c;
+        }
+        return solved("max degree < k");
+    }
+    return false;
+}
+
+// Core Peeling 
+// a region outside the k-core had fewer than k neighbors left when it was peeled, so
+// any k-coloring of the k-core extends greedily in reverse peeling order. probe(k)
+// runs with the k-core swapped in as the current graph and leaves its coloring in
+// `assignment`. The core's arc index is derived from the full one, and its dom/wdeg
+// edge weights and saved phases are copied in and written back, so both keep
+// carrying over between probes. Returns -1 when nothing peels, else whether k colors
+// suffice.
+bool USE_CORE_PEELING = true;
+
+template <class Probe>
+int peeledProbe(int k, bool verbose, Probe probe) {
+    CoreDecomposition cd = coreDecomposition();
+    vector<int> kept, index(N, -1);
+    for (int v : cd.removal)
+        if (cd.core[v] >= k) {
+            index[v] = (int)kept.size();
+            kept.push_back(v);
+        }
+    if ((int)kept.size() == N) return -1;
+    if (verbose) cout << "  Peeled " << N - (int)kept.size() << " regions outside the " << k << "-core\n";
 
-    for (int u = 0; u < N; ++u) {
-        for (int v : graphAdj[u]) {
-            if (v <= u) continue; // each edge once
-            int r1 = pos[u].r, c1 = pos[u].c+1; // center of node
-            int r2 = pos[v].r, c2 = pos[v].c+1;
-            int cr = r1, cc = c1;
-            while (cr != r2 || cc != c2) {
-                int dr = (r2>cr)?1:(r2<cr)?-1:0;
-                int dc = (c2>cc)?1:(c2<cc)?-1:0;
-                if (dr==0 && dc!=0) setCharSafe(cr,cc,'-');
-                else if (dc==0 && dr!=0) setCharSafe(cr,cc,'|');
-                else if (dr==dc) setCharSafe(cr,cc,'\\');
-                else setCharSafe(cr,cc,'/');
-                if (cr!=r2) cr+=dr;
-                if (cc!=c2) cc+=dc;
+    vector<int> keptColors;
+    if (!kept.empty()) {
+        // core arcs in slot order, arcOf[a] = the same arc in the full index
+        int n = (int)kept.size();
+        vector<vector<int>> sub(n);
+        vector<int> offset(n + 1, 0), from, arcOf;
+        for (int i = 0; i < n; ++i) {
+            int v = kept[i];
+            for (int j = 0; j < (int)graphAdj[v].size(); ++j) {
+                int u = graphAdj[v][j];
+                if (index[u] < 0) continue;
+                sub[i].push_back(index[u]);
+                from.push_back(i);
+                arcOf.push_back(adjOffset[v] + j);
             }
+            offset[i + 1] = (int)arcOf.size();
         }
+        int arcs = (int)arcOf.size();
+        vector<int> coreArc(adjOffset[N], -1), rev(arcs);
+        for (int a = 0; a < arcs; ++a) coreArc[arcOf[a]] = a;
+        vector<double> weight(arcs);
+        for (int a = 0; a < arcs; ++a) {
+            rev[a] = coreArc[arcRev[arcOf[a]]];
+            weight[a] = edgeWeight[min(arcOf[a], arcRev[arcOf[a]])];
+        }
+        if ((int)savedPhase.size() != N) savedPhase.assign(N, -1);
+        vector<int> phase(n);
+        for (int i = 0; i < n; ++i) phase[i] = savedPhase[kept[i]];
+
+        int fullN = N, rescales = wdegRescales;
+        keptColors.assign(n, -1);
+        auto swapGraph = [&]() {
+            swap(graphAdj, sub);
+            swap(adjOffset, offset);
+            swap(arcFrom, from);
+            swap(arcRev, rev);
+            swap(edgeWeight, weight);
+            swap(savedPhase, phase);
+            swap(assignment, keptColors);
+        };
+        swapGraph();
+        N = n;
+        bool ok = probe(k);
+        swapGraph();
+        N = fullN;
+
+        // edges outside the core follow any rescale done inside it
+        for (int r = rescales; r < wdegRescales; ++r)
+            for (double& w : edgeWeight) w *= 1e-100;
+        for (int a = 0; a < arcs; ++a) edgeWeight[min(arcOf[a], arcRev[arcOf[a]])] = weight[min(a, rev[a])];
+        for (int i = 0; i < n; ++i) savedPhase[kept[i]] = phase[i];
+        if (!ok) return 0;
     }
 
-    // Draw nodes
-    for (int i=0;i<N;i++) {
-        string s="("+to_string(i)+")";
-        int r=pos[i].r, c=pos[i].c;
-        for (int j=0;j<s.size();j++) {
-            if (c+j<canvasCols) canvas[r][c+j]=s[j];
+    fill(assignment.begin(), assignment.end(), -1);
+    for (int i = 0; i < (int)kept.size(); ++i) assignment[kept[i]] = keptColors[i];
+    vector<int> mark(k, -1); // mark[c] == v -> color c taken by a neighbor of v
+    for (auto it = cd.removal.rbegin(); it != cd.removal.rend(); ++it) {
+        int v = *it;
+        if (cd.core[v] >= k) continue;
+        for (int nb : graphAdj[v])
+            if (assignment[nb] != -1) mark[assignment[nb]] = v;
+        int c = 0;
+        while (mark[c] == v) ++c; // at most core[v] < k colors are taken
+        assignment[v] = c;
+    }
+    return 1;
+}
+
+// Resumable Search 
+// explicit-stack k-coloring search that can be suspended and resumed, so one thread
+// can interleave many solves. resume() runs until a solution is reached or `budget`
+// more nodes were expanded; after a SOLUTION the next resume() continues past it,
+// which enumerates colorings lazily. A task owns a copy of its graph and uses the
+// full domains 0..k-1 with dynamic MRV (fewest free colors, ties by index).
+// With breakSymmetry only one unused color is ever tried, so each coloring comes
+// out once per class of color permutations.
+enum class SearchStatus { RUNNING, SOLUTION, EXHAUSTED };
+
+long long SEARCH_SLICE_NODES = 4096; // per-task node budget in runInterleaved()
+
+struct SearchTask {
+    struct Frame { int var, nextColor, prevMax; };
+
+    vector<vector<int>> adj;
+    int n = 0, k = 0;
+    vector<int> colors;         // -1 = unassigned
+    vector<int> nbCount;        // nbCount[v*k + c] = assigned neighbors of v with color c
+    vector<int> freeCount;      // colors still open to v
+    vector<Frame> stack;
+    long long nodes = 0;
+    bool started = false, exhausted = false;
+    bool breakSymmetry;
+    int maxUsed = -1;           // highest color on the current path
+
+    SearchTask(const vector<vector<int>>& graph, int colorsK, bool symmetryBreaking = false)
+        : adj(graph), n((int)graph.size()), k(colorsK),
+          colors(n, -1), nbCount((size_t)n * colorsK, 0), freeCount(n, colorsK),
+          breakSymmetry(symmetryBreaking) {
+        stack.reserve(n);
+    }
+
+    void assign(int v, int c) {
+        colors[v] = c;
+        for (int nb : adj[v])
+            if (nbCount[(size_t)nb * k + c]++ == 0) --freeCount[nb];
+    }
+
+    void unassign(int v) {
+        int c = colors[v];
+        colors[v] = -1;
+        for (int nb : adj[v])
+            if (--nbCount[(size_t)nb * k + c] == 0) ++freeCount[nb];
+    }
+
+    int select() const {
+        int best = -1;
+        for (int i = 0; i < n; ++i)
+            if (colors[i] == -1 && (best == -1 || freeCount[i] < freeCount[best])) best = i;
+        return best;
+    }
+
+    // push the next variable, or report a full assignment
+    bool descend() {
+        if ((int)stack.size() == n) return true;
+        stack.push_back({select(), 0, maxUsed});
+        return false;
+    }
+
+    SearchStatus resume(long long budget) {
+        TraceScope trace("slice", k);
+        if (exhausted) return SearchStatus::EXHAUSTED;
+        if (!started) {
+            started = true;
+            if (k <= 0 && n > 0) { exhausted = true; return SearchStatus::EXHAUSTED; }
+            if (descend()) return SearchStatus::SOLUTION; // empty graph
+        }
+        long long stop = budget > LLONG_MAX - nodes ? LLONG_MAX : nodes + budget;
+        while (true) {
+            if (stack.empty()) { exhausted = true; return SearchStatus::EXHAUSTED; }
+            Frame& f = stack.back();
+            if (colors[f.var] != -1) unassign(f.var); // coming back to this frame
+            maxUsed = f.prevMax;
+            int limit = breakSymmetry ? min(k, f.prevMax + 2) : k;
+            int c = f.nextColor;
+            while (c < limit && nbCount[(size_t)f.var * k + c] != 0) ++c;
+            if (c >= limit) { stack.pop_back(); continue; }
+            f.nextColor = c + 1;
+            assign(f.var, c);
+            maxUsed = max(maxUsed, c);
+            ++nodes;
+            if (descend()) return SearchStatus::SOLUTION;
+            if (nodes >= stop) return SearchStatus::RUNNING;
         }
     }
+};
 
-    // Print canvas
-    for (auto &line : canvas) cout << line << '\n';
-    cout << '\n';
+// round-robin over the tasks, SEARCH_SLICE_NODES at a time, until all are exhausted
+// or onSolution returns false for them; onSolution(taskIndex, task) sees each solution
+template <class OnSolution>
+void runInterleaved(vector<SearchTask>& tasks, OnSolution onSolution) {
+    vector<char> done(tasks.size(), 0);
+    size_t active = tasks.size();
+    while (active > 0) {
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            if (done[i]) continue;
+            SearchStatus st = tasks[i].resume(SEARCH_SLICE_NODES);
+            bool finished = st == SearchStatus::EXHAUSTED ||
+                            (st == SearchStatus::SOLUTION && !onSolution(i, tasks[i]));
+            if (finished) { done[i] = 1; --active; }
+        }
+    }
 }
 
+// Solution Enumeration / Counting 
+bool ENUMERATE_SOLUTIONS = false;   // stream every chi-coloring (one per permutation class)
+bool COUNT_SOLUTIONS = false;       // report the number of chi-colorings
+size_t COUNT_CACHE_ENTRIES = 1 << 22;
 
-int main() {
-    // pick a random N between 6 and 12 (you can change range)
-    mt19937 rng((unsigned)chrono::system_clock::now().time_since_epoch().count());
-    uniform_int_distribution<int> distNodes(6, 12);
-    N = distNodes(rng);
+// streams each k-coloring to onSolution(colors), stop early by returning false.
+// With breakSymmetry one coloring per color-permutation class. Returns how many were produced.
+// The search runs SEARCH_SLICE_NODES at a time and stops past searchDeadline, incomplete says so.
+template <class OnSolution>
+long long enumerateColorings(int k, bool breakSymmetry, OnSolution onSolution, bool* incomplete = nullptr) {
+    SearchTask task(graphAdj, k, breakSymmetry);
+    long long produced = 0;
+    bool timedOut = false;
+    while (true) {
+        SearchStatus st = task.resume(SEARCH_SLICE_NODES);
+        if (st == SearchStatus::EXHAUSTED) break;
+        if (st == SearchStatus::SOLUTION) {
+            ++produced;
+            if (!onSolution(task.colors)) break;
+        }
+        if (TIME_LIMIT_SEC > 0 && chrono::steady_clock::now() > searchDeadline) { timedOut = true; break; }
+    }
+    if (incomplete) *incomplete = timedOut;
+    return produced;
+}
 
-    // generate graph (keeps original generator logic)
-    generateRandomGraph(N);
+// model counting: number of proper k-colorings, i.e. P(G, k). Branches on a region,
+// splits what is left into connected components and multiplies their counts;
+// components are cached by (regions, colors banned by assigned neighbors).
+// Counts saturate at UINT64_MAX, overflowed says so. Needs k <= 64. Past
+// searchDeadline unfinished components count 0, so the total is a lower bound and
+// timedOut says so.
+struct ColoringCounter {
+    int k;
+    vector<int> colors;         // -1 = unassigned
+    vector<uint64_t> banned;    // colors held by assigned neighbors
+    vector<int> stamp;
+    int stampId = 0;
+    unordered_map<string, uint64_t> cache;
+    bool overflowed = false;
+    bool timedOut = false;
+    long long nodes = 0;
 
-    // print adjacency list + diagram
-    printAdjacencyList();
-    printGraphDiagram();
+    explicit ColoringCounter(int colorsK)
+        : k(colorsK), colors(N, -1), banned(N, 0), stamp(N, 0) {}
 
-    // run minimal color search
-    cout << "\nsolving (trying k = 1..N)\n";
-    int foundK = -1;
-    for (int k = 1; k <= N; ++k) {
-        cout << "Trying k = " << k << " ...\n";
-        bool ok = solveWithKColors(k, /*verbose=*/true);
-        if (ok) { foundK = k; break; }
+    uint64_t mul(uint64_t a, uint64_t b) {
+        uint64_t r;
+        if (__builtin_mul_overflow(a, b, &r)) { overflowed = true; return UINT64_MAX; }
+        return r;
+    }
+    uint64_t add(uint64_t a, uint64_t b) {
+        uint64_t r;
+        if (__builtin_add_overflow(a, b, &r)) { overflowed = true; return UINT64_MAX; }
+        return r;
     }
 
-    if (foundK != -1) {
-        cout << "\nSolution found with " << foundK << " colors:\n";
-        for (int i = 0; i < N; ++i)
-            cout << "Region " << i << " -> Color " << assignment[i] << "\n";
-    } else {
-        cout << "\nNo valid coloring found for k in [1.." << N << "].\n";
+    // connected components of the unassigned regions in `regions`
+    vector<vector<int>> components(const vector<int>& regions) {
+        ++stampId;
+        for (int v : regions) stamp[v] = stampId;
+        vector<vector<int>> comps;
+        for (int s : regions) {
+            if (stamp[s] != stampId) continue;
+            comps.push_back({s});
+            stamp[s] = -stampId;
+            for (size_t h = 0; h < comps.back().size(); ++h) {
+                int u = comps.back()[h];
+                for (int nb : graphAdj[u])
+                    if (stamp[nb] == stampId) { stamp[nb] = -stampId; comps.back().push_back(nb); }
+            }
+        }
+        return comps;
+    }
+
+    uint64_t countComponent(vector<int> comp) {
+        if (comp.size() == 1) return (uint64_t)(k - __builtin_popcountll(banned[comp[0]]));
+        if (timedOut || ((++nodes & 1023) == 0 && TIME_LIMIT_SEC > 0 && chrono::steady_clock::now() > searchDeadline)) {
+            timedOut = true;
+            return 0;
+        }
+        sort(comp.begin(), comp.end());
+        string key;
+        key.reserve(comp.size() * 12);
+        for (int v : comp) {
+            key.append((const char*)&v, sizeof v);
+            key.append((const char*)&banned[v], sizeof banned[v]);
+        }
+        auto it = cache.find(key);
+        if (it != cache.end()) return it->second;
+
+        // branch on the region with most unassigned neighbors, it splits the component soonest
+        int var = -1, bestDeg = -1;
+        for (int v : comp) {
+            int deg = 0;
+            for (int nb : graphAdj[v]) deg += colors[nb] == -1;
+            if (deg > bestDeg) { bestDeg = deg; var = v; }
+        }
+        vector<int> rest;
+        rest.reserve(comp.size() - 1);
+        for (int v : comp) if (v != var) rest.push_back(v);
+
+        uint64_t total = 0;
+        for (int c = 0; c < k; ++c) {
+            uint64_t bit = 1ULL << c;
+            if (banned[var] & bit) continue;
+            vector<int> touched; // neighbors that newly lose c
+            for (int nb : graphAdj[var])
+                if (colors[nb] == -1 && !(banned[nb] & bit)) { banned[nb] |= bit; touched.push_back(nb); }
+            colors[var] = c;
+            uint64_t ways = 1;
+            for (auto& sub : components(rest)) {
+                ways = mul(ways, countComponent(sub));
+                if (ways == 0) break;
+            }
+            total = add(total, ways);
+            colors[var] = -1;
+            for (int nb : touched) banned[nb] &= ~bit;
+        }
+        if (timedOut) return total; // partial, not cached
+        if (cache.size() >= COUNT_CACHE_ENTRIES) cache.clear(); // bound memory, keep going
+        cache.emplace(move(key), total);
+        return total;
+    }
+
+    uint64_t run() {
+        vector<int> all(N);
+        for (int i = 0; i < N; ++i) all[i] = i;
+        uint64_t ways = 1;
+        for (auto& comp : components(all)) ways = mul(ways, countComponent(comp));
+        return ways;
+    }
+};
+
+uint64_t countColorings(int k, bool* overflowed = nullptr, bool* incomplete = nullptr) {
+    if (k > 64) { // banned-color masks are 64 bits wide
+        if (overflowed) *overflowed = true;
+        return UINT64_MAX;
+    }
+    ColoringCounter counter(k);
+    uint64_t ways = k <= 0 ? (N == 0 ? 1 : 0) : counter.run();
+    if (overflowed) *overflowed = counter.overflowed;
+    if (incomplete) *incomplete = counter.timedOut;
+    return ways;
+}
+
+// Chromatic Polynomial 
+// P(G, x) by deletion-contraction (addition-contraction on dense graphs) over
+// 64-bit adjacency rows, so at most 64 regions. Components are multiplied, trees,
+// cycles and complete graphs use their closed forms, simplicial regions and
+// separators of one region or one edge split the graph, and connected subgraphs are
+// memoized under a color-refinement relabeling: equal keys are always isomorphic,
+// some isomorphic pairs may still miss. Coefficients are exact 64-bit integers,
+// overflowed is set if one does not fit. The memo is cleared when it reaches
+// POLY_MEMO_ENTRIES, and past searchDeadline the engine unwinds with timedOut set.
+bool USE_CHROMATIC_POLYNOMIAL = false;
+size_t POLY_MEMO_ENTRIES = 1 << 16;
+using Poly = vector<long long>; // coef[i] multiplies x^i
+
+struct PolynomialEngine {
+    bool overflowed = false;
+    bool timedOut = false;      // the deadline passed, the result is meaningless
+    long long calls = 0;
+    unordered_map<string, Poly> memo;
+
+    void remember(string key, const Poly& p) {
+        if (memo.size() >= POLY_MEMO_ENTRIES) memo.clear(); // bound memory, keep going
+        memo.emplace(move(key), p);
+    }
+
+    long long add(long long a, long long b) {
+        long long r;
+        if (__builtin_add_overflow(a, b, &r)) overflowed = true;
+        return r;
+    }
+    long long mul(long long a, long long b) {
+        long long r;
+        if (__builtin_mul_overflow(a, b, &r)) overflowed = true;
+        return r;
+    }
+
+    Poly polyMul(const Poly& a, const Poly& b) {
+        Poly r(a.size() + b.size() - 1, 0);
+        for (size_t i = 0; i < a.size(); ++i)
+            for (size_t j = 0; j < b.size(); ++j)
+                if (a[i] && b[j]) r[i + j] = add(r[i + j], mul(a[i], b[j]));
+        return r;
+    }
+    Poly polyAdd(const Poly& a, const Poly& b, long long sign) {
+        Poly r(max(a.size(), b.size()), 0);
+        for (size_t i = 0; i < a.size(); ++i) r[i] = a[i];
+        for (size_t i = 0; i < b.size(); ++i) r[i] = add(r[i], mul(sign, b[i]));
+        return r;
+    }
+    Poly polyPow(const Poly& base, int e) {
+        Poly r = {1};
+        for (int i = 0; i < e; ++i) r = polyMul(r, base);
+        return r;
+    }
+
+    // exact division by (x - r)
+    static Poly divideRoot(const Poly& p, long long r) {
+        Poly q(p.size() - 1, 0);
+        long long carry = 0;
+        for (int d = (int)p.size() - 1; d >= 1; --d) {
+            carry = p[d] + carry * r;
+            q[d - 1] = carry;
+        }
+        return q;
+    }
+
+    // regions reachable from start inside mask
+    static uint64_t reach(const vector<uint64_t>& g, uint64_t mask, int start) {
+        uint64_t seen = 1ULL << start, frontier = seen;
+        while (frontier) {
+            uint64_t next = 0;
+            for (uint64_t r = frontier; r; r &= r - 1) next |= g[__builtin_ctzll(r)];
+            next &= mask;
+            frontier = next & ~seen;
+            seen |= next;
+        }
+        return seen;
+    }
+
+    static int edgeCount(const vector<uint64_t>& g) {
+        int m = 0;
+        for (uint64_t row : g) m += __builtin_popcountll(row);
+        return m / 2;
+    }
+
+    // subgraph induced by the vertices in mask, renumbered in mask order
+    static vector<uint64_t> induced(const vector<uint64_t>& g, uint64_t mask) {
+        vector<int> newId(g.size(), -1);
+        int n = 0;
+        for (uint64_t m = mask; m; m &= m - 1) newId[__builtin_ctzll(m)] = n++;
+        vector<uint64_t> h(n, 0);
+        for (uint64_t m = mask; m; m &= m - 1) {
+            int v = __builtin_ctzll(m);
+            for (uint64_t r = g[v] & mask; r; r &= r - 1) h[newId[v]] |= 1ULL << newId[__builtin_ctzll(r)];
+        }
+        return h;
+    }
+
+    // merge v into u (u != v), dropping v and any u-v edge
+    static vector<uint64_t> contract(vector<uint64_t> g, int u, int v) {
+        for (uint64_t r = g[v]; r; r &= r - 1) {
+            int w = __builtin_ctzll(r);
+            g[w] |= 1ULL << u;
+        }
+        g[u] |= g[v];
+        g[u] &= ~(1ULL << u);
+        uint64_t keep = ~(1ULL << v) & (g.size() == 64 ? ~0ULL : (1ULL << g.size()) - 1);
+        return induced(g, keep);
+    }
+
+    static uint64_t mix(uint64_t h) {
+        h ^= h >> 33; h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ULL;
+        return h ^ (h >> 33);
+    }
+
+    // a few rounds of hashed color refinement, then vertices ordered by (hash, index).
+    // The key is the relabeled adjacency itself, so hash collisions only cost cache hits.
+    static string canonicalKey(const vector<uint64_t>& g) {
+        int n = (int)g.size();
+        uint64_t h[64], next[64];
+        for (int v = 0; v < n; ++v) h[v] = mix((uint64_t)__builtin_popcountll(g[v]));
+        for (int round = 0; round < 3; ++round) {
+            for (int v = 0; v < n; ++v) {
+                uint64_t acc = h[v] * 0x9e3779b97f4a7c15ULL;
+                for (uint64_t r = g[v]; r; r &= r - 1) acc += mix(h[__builtin_ctzll(r)]);
+                next[v] = mix(acc);
+            }
+            memcpy(h, next, n * sizeof(uint64_t));
+        }
+        int order[64], pos[64];
+        for (int v = 0; v < n; ++v) order[v] = v;
+        sort(order, order + n, [&](int a, int b){ return h[a] != h[b] ? h[a] < h[b] : a < b; });
+        for (int i = 0; i < n; ++i) pos[order[i]] = i;
+        string key(1 + n * sizeof(uint64_t), '\0');
+        key[0] = (char)n;
+        for (int i = 0; i < n; ++i) {
+            uint64_t row = 0;
+            for (uint64_t r = g[order[i]]; r; r &= r - 1) row |= 1ULL << pos[__builtin_ctzll(r)];
+            memcpy(&key[1 + i * sizeof(uint64_t)], &row, sizeof row);
+        }
+        return key;
+    }
+
+    Poly solve(const vector<uint64_t>& g) {
+        int n = (int)g.size();
+        if (n == 0) return {1};
+        if (timedOut || ((++calls & 1023) == 0 && TIME_LIMIT_SEC > 0 && chrono::steady_clock::now() > searchDeadline)) {
+            timedOut = true;
+            return Poly(n + 1, 0); // right degree, so separator divisions stay well-formed
+        }
+        uint64_t all = n == 64 ? ~0ULL : (1ULL << n) - 1;
+
+        // split into connected components
+        uint64_t seen = reach(g, all, 0);
+        if (seen != all) return polyMul(solve(induced(g, seen)), solve(induced(g, all & ~seen)));
+
+        int m = edgeCount(g);
+        Poly x = {0, 1}, xm1 = {-1, 1};
+        if (m == n - 1) return polyMul(x, polyPow(xm1, n - 1)); // tree
+        if (m == n * (n - 1) / 2) {                             // complete: x(x-1)...(x-n+1)
+            Poly r = {1};
+            for (int i = 0; i < n; ++i) r = polyMul(r, Poly{-i, 1});
+            return r;
+        }
+        bool cycle = m == n;
+        for (int v = 0; v < n && cycle; ++v) cycle = __builtin_popcountll(g[v]) == 2;
+        if (cycle) return polyAdd(polyPow(xm1, n), xm1, (n % 2 == 0) ? 1 : -1); // (x-1)^n + (-1)^n (x-1)
+
+        // simplicial region (neighbors form a clique) of degree d: P(G) = (x - d) P(G - v)
+        for (int v = 0; v < n; ++v) {
+            int d = __builtin_popcountll(g[v]);
+            bool clique = true;
+            for (uint64_t r = g[v]; r && clique; r &= r - 1) {
+                int w = __builtin_ctzll(r);
+                clique = (g[v] & ~g[w] & ~(1ULL << w)) == 0;
+            }
+            if (clique) return polyMul(Poly{-d, 1}, solve(induced(g, all & ~(1ULL << v))));
+        }
+
+        string key = canonicalKey(g);
+        auto it = memo.find(key);
+        if (it != memo.end()) return it->second;
+
+        // clique separator S of one region or one edge: P(G) = P(G1) P(G2) / P(K_|S|)
+        for (int v = 0; v < n; ++v) {
+            for (uint64_t cand = (1ULL << v) | (g[v] & ~((2ULL << v) - 1)); cand; ) {
+                int w = __builtin_ctzll(cand);
+                cand &= cand - 1;
+                uint64_t sep = (1ULL << v) | (1ULL << w);
+                uint64_t rest = all & ~sep;
+                if (!rest) continue;
+                uint64_t part = reach(g, rest, __builtin_ctzll(rest));
+                if (part == rest) continue;
+                Poly res = polyMul(solve(induced(g, part | sep)), solve(induced(g, (rest & ~part) | sep)));
+                for (int r = 0; r < __builtin_popcountll(sep); ++r) res = divideRoot(res, r);
+                remember(move(key), res);
+                return res;
+            }
+        }
+
+        Poly res;
+        if (2 * m > n * (n - 1) / 2) {
+            // dense: P(G) = P(G + uv) + P(G / uv) for a non-edge uv, u of highest
+            // degree that still has one (the graph is not complete)
+            int u = -1;
+            for (int w = 0; w < n; ++w) {
+                int deg = __builtin_popcountll(g[w]);
+                if (deg < n - 1 && (u == -1 || deg > __builtin_popcountll(g[u]))) u = w;
+            }
+            int v = __builtin_ctzll(all & ~g[u] & ~(1ULL << u));
+            vector<uint64_t> plus = g;
+            plus[u] |= 1ULL << v;
+            plus[v] |= 1ULL << u;
+            res = polyAdd(solve(plus), solve(contract(g, u, v)), 1);
+        } else {
+            // sparse: P(G) = P(G - uv) - P(G / uv) for an edge uv at a lowest-degree
+            // region, deleting drives it toward simplicial
+            int u = 0;
+            for (int w = 1; w < n; ++w)
+                if (__builtin_popcountll(g[w]) < __builtin_popcountll(g[u])) u = w;
+            int v = -1;
+            for (uint64_t r = g[u]; r; r &= r - 1) {
+                int w = __builtin_ctzll(r);
+                if (v == -1 || __builtin_popcountll(g[w]) > __builtin_popcountll(g[v])) v = w;
+            }
+            vector<uint64_t> minus = g;
+            minus[u] &= ~(1ULL << v);
+            minus[v] &= ~(1ULL << u);
+            res = polyAdd(solve(minus), solve(contract(g, u, v)), -1);
+        }
+        remember(move(key), res);
+        return res;
+    }
+};
+
+// P(graphAdj, x); needs N <= 64. timedOut: searchDeadline cut it short, p is not usable
+Poly chromaticPolynomial(bool* overflowed = nullptr, bool* timedOut = nullptr) {
+    vector<uint64_t> g(N, 0);
+    for (int u = 0; u < N; ++u)
+        for (int v : graphAdj[u]) g[u] |= 1ULL << v;
+    PolynomialEngine engine;
+    Poly p = engine.solve(g);
+    while (p.size() > 1 && p.back() == 0) p.pop_back();
+    if (overflowed) *overflowed = engine.overflowed;
+    if (timedOut) *timedOut = engine.timedOut;
+    return p;
+}
+
+// smallest k >= 1 with P(k) > 0. P(k) is a coloring count in [0, k^N], so it is
+// zero exactly when it vanishes modulo enough primes to cover k^N (CRT)
+int chromaticNumberFromPolynomial(const Poly& p) {
+    int n = (int)p.size() - 1;
+    vector<long long> primes;
+    for (long long q = (1LL << 31) - 1; primes.size() < 16; q -= 2) {
+        bool prime = true;
+        for (long long d = 3; d * d <= q && prime; d += 2) prime = q % d != 0;
+        if (prime) primes.push_back(q);
+    }
+    for (int k = 1; k <= max(1, n); ++k) {
+        double bits = n * log2((double)k) + 1;
+        size_t need = min(primes.size(), (size_t)(bits / 30) + 1);
+        bool zero = true;
+        for (size_t i = 0; i < need && zero; ++i) {
+            long long q = primes[i], val = 0;
+            for (int d = n; d >= 0; --d) val = (val * k + (p[d] % q + q) % q) % q; // < 2^38, no overflow
+            zero = val == 0;
+        }
+        if (!zero) return k;
+    }
+    return n;
+}
+
+string formatPolynomial(const Poly& p) {
+    string out;
+    for (int d = (int)p.size() - 1; d >= 0; --d) {
+        long long c = p[d];
+        if (c == 0) continue;
+        if (!out.empty()) out += c < 0 ? " - " : " + ";
+        else if (c < 0) out += "-";
+        long long a = c < 0 ? -c : c;
+        if (a != 1 || d == 0) out += to_string(a);
+        if (d >= 1) out += "x";
+        if (d >= 2) out += "^" + to_string(d);
+    }
+    return out.empty() ? "0" : out;
+}
+
+// Bounds 
+// regions sorted by degree, highest first (ties by index)
+vector<int> degreeOrder() {
+    vector<int> order(N);
+    for (int i = 0; i < N; ++i) order[i] = i;
+    stable_sort(order.begin(), order.end(), [](int a, int b){
+        return graphAdj[a].size() > graphAdj[b].size();
+    });
+    return order;
+}
+
+// greedy coloring in the given order -> number of colors used (upper bound on chi)
+int greedyColoring(const vector<int>& order, vector<int>& colors) {
+    colors.assign(N, -1);
+    vector<int> mark(N + 1, -1); // mark[c] == v -> color c taken by a neighbor of v
+    int used = 0;
+    for (int v : order) {
+        for (int nb : graphAdj[v])
+            if (colors[nb] != -1) mark[colors[nb]] = v;
+        int c = 0;
+        while (mark[c] == v) ++c;
+        colors[v] = c;
+        used = max(used, c + 1);
+    }
+    return used;
+}
+
+// Max Clique (BBMC) 
+// bit-parallel branch and bound; a greedy coloring of the candidate set bounds the
+// clique size reachable from it. Any clique found is a valid lower bound on chi,
+// exact == true means it is also maximum. Bitsets are quadratic in the set they
+// cover, so they are only built over regions that can still beat the incumbent:
+// those with core number >= its size, or, when too many remain, each region plus its
+// earlier neighbors in smallest-last order (every clique is one of those). Above
+// CLIQUE_BITSET_LIMIT the greedy clique is kept as an inexact bound.
+int CLIQUE_TIME_LIMIT_MS = 1000;
+int CLIQUE_BITSET_LIMIT = 4096;     // regions per bitset search, 2 MB of adjacency
+
+struct CliqueResult {
+    vector<int> clique;     // region ids
+    bool exact = true;      // false if the time or size limit cut the search short
+    long long nodes = 0;
+};
+
+struct MaxCliqueSolver {
+    const CoreDecomposition& cd;
+    EarlierNeighbors en;
+    int W = 0;                          // 64-bit words per bitset
+    vector<int> order;                  // bit position -> region
+    vector<vector<uint64_t>> adj;       // adjacency bitsets over bit positions
+    vector<int> slot;                   // region -> bit position, -1 outside the set
+    vector<int> cur, best;              // cur in bit positions, best in regions
+    long long nodes = 0;
+    bool timedOut = false;
+    chrono::steady_clock::time_point deadline;
+
+    explicit MaxCliqueSolver(const CoreDecomposition& c) : cd(c), en(c), slot(N, -1) {}
+
+    static bool empty(const vector<uint64_t>& s) {
+        for (uint64_t w : s) if (w) return false;
+        return true;
+    }
+
+    // BBMC color sort: vertices of P in color-class order, only those whose color
+    // can still beat the incumbent (color >= kmin)
+    void colorSort(const vector<uint64_t>& P, int kmin, vector<int>& U, vector<int>& colors) {
+        vector<uint64_t> left = P, Q(W);
+        U.clear(); colors.clear();
+        int k = 0;
+        while (!empty(left)) {
+            ++k;
+            Q = left;
+            for (int w = 0; w < W; ++w) {
+                while (Q[w]) {
+                    int v = w * 64 + __builtin_ctzll(Q[w]);
+                    left[w] &= ~(1ULL << (v & 63));
+                    for (int x = w; x < W; ++x) Q[x] &= ~adj[v][x];
+                    Q[w] &= ~(1ULL << (v & 63));
+                    if (k >= kmin) { U.push_back(v); colors.push_back(k); }
+                }
+            }
+        }
+    }
+
+    void expand(vector<uint64_t>& P) {
+        if (timedOut) return;
+        if ((++nodes & 1023) == 0 && chrono::steady_clock::now() > deadline) {
+            timedOut = true;
+            return;
+        }
+
+        vector<int> U, colors;
+        int kmin = (int)best.size() - (int)cur.size() + 1;
+        colorSort(P, kmin, U, colors);
+
+        vector<uint64_t> newP(W);
+        for (int i = (int)U.size() - 1; i >= 0; --i) {
+            if ((int)cur.size() + colors[i] <= (int)best.size()) return; // bound
+            int v = U[i];
+            cur.push_back(v);
+            for (int w = 0; w < W; ++w) newP[w] = P[w] & adj[v][w];
+            if (empty(newP)) {
+                if (cur.size() > best.size()) {
+                    best.clear();
+                    for (int p : cur) best.push_back(order[p]);
+                }
+            } else {
+                expand(newP);
+            }
+            cur.pop_back();
+            P[v / 64] &= ~(1ULL << (v & 63));
+            if (timedOut) return;
+        }
+    }
+
+    // incumbent: from each region, add its earlier neighbors highest core first while
+    // they stay adjacent to everything picked
+    void greedyClique() {
+        vector<int> cands, pick;
+        for (int v : en.order) {
+            if (en.size(v) + 1 <= (int)best.size()) continue;
+            cands.assign(en.begin(v), en.end(v));
+            stable_sort(cands.begin(), cands.end(), [&](int a, int b) { return cd.core[a] > cd.core[b]; });
+            pick = {v};
+            for (int u : cands) {
+                bool all = true;
+                for (size_t i = 1; i < pick.size() && all; ++i) all = en.adjacent(u, pick[i]);
+                if (all) pick.push_back(u);
+            }
+            if (pick.size() > best.size()) best = pick;
+        }
+    }
+
+    // BBMC over the subgraph induced by verts, highest degree first
+    void search(vector<int> verts) {
+        stable_sort(verts.begin(), verts.end(), [](int a, int b) {
+            return graphAdj[a].size() > graphAdj[b].size();
+        });
+        order = move(verts);
+        int n = (int)order.size();
+        W = (n + 63) / 64;
+        for (int i = 0; i < n; ++i) slot[order[i]] = i;
+        adj.assign(n, vector<uint64_t>(W, 0));
+        for (int i = 0; i < n; ++i)
+            for (const int* u = en.begin(order[i]); u != en.end(order[i]); ++u) {
+                int j = slot[*u];
+                if (j < 0) continue;
+                adj[i][j / 64] |= 1ULL << (j & 63);
+                adj[j][i / 64] |= 1ULL << (i & 63);
+            }
+        for (int v : order) slot[v] = -1;
+
+        vector<uint64_t> P(W, 0);
+        for (int i = 0; i < n; ++i) P[i / 64] |= 1ULL << (i & 63);
+        expand(P);
+    }
+
+    CliqueResult run(int timeLimitMs) {
+        deadline = chrono::steady_clock::now() + chrono::milliseconds(timeLimitMs);
+        greedyClique();
+        // a larger clique lies in the (|best|)-core
+        vector<int> cands;
+        for (int v = 0; v < N; ++v)
+            if (cd.core[v] >= (int)best.size()) cands.push_back(v);
+        bool capped = false;
+        if ((int)cands.size() <= CLIQUE_BITSET_LIMIT) {
+            search(move(cands));
+        } else if (cd.degeneracy < CLIQUE_BITSET_LIMIT) {
+            for (int v : en.order) {
+                if (timedOut) break;
+                cands = {v};
+                for (const int* u = en.begin(v); u != en.end(v); ++u)
+                    if (cd.core[*u] >= (int)best.size()) cands.push_back(*u);
+                if (cands.size() > best.size()) search(move(cands));
+            }
+        } else {
+            capped = true;
+        }
+
+        CliqueResult res;
+        res.clique = best;
+        res.exact = !timedOut && !capped;
+        res.nodes = nodes;
+        return res;
+    }
+};
+
+CliqueResult maxClique(const CoreDecomposition& cd, int timeLimitMs = CLIQUE_TIME_LIMIT_MS) {
+    MaxCliqueSolver solver(cd);
+    return solver.run(timeLimitMs);
+}
+
+// Planar Maps 
+// a planar graph has degeneracy <= 5 and omega <= 4. planarColoring() colors in
+// smallest-last order, so each region meets at most 5 colored neighbors; when they
+// hold all five colors, a Kempe swap frees one: for the colors a, b of two of them,
+// the {a, b} chain through the a-neighbor is flipped unless it reaches the b-neighbor,
+// and on a planar graph some pair always works. Chain walks are short on maps but
+// O(N) each in the worst case, so past a budget of 64 (N + arcs) walked the coloring
+// starts over with contractionColoring(), which is linear. Regions left with color 4
+// are then pushed into 0..3 the same way, in PLANAR_KEMPE_PASSES shuffled rounds
+// within a budget of the same size; a region no swap frees trades colors with a neighbor
+// that alone holds some color (a random walk of the fifth color). Other graphs still
+// get a valid coloring, possibly with more colors.
+bool PLANAR_INPUT = false;          // --planar: trust that the graph is planar
+int PLANAR_KEMPE_PASSES = 8;
+const int PLANAR_LIGHT_DEGREE = 11;
+
+struct KempeChains {
+    vector<int>& colors;
+    vector<int> seen, chain;
+    int stamp = 0;
+    long long work = 0;             // regions and arcs walked
+
+    explicit KempeChains(vector<int>& c) : colors(c), seen(c.size(), 0) {}
+
+    // the {a, b} chain through x into `chain`; false as soon as it reaches a region u with stop(u)
+    template <class Stop>
+    bool collect(int x, int a, int b, Stop stop) {
+        ++stamp;
+        chain.clear();
+        chain.push_back(x);
+        seen[x] = stamp;
+        for (size_t i = 0; i < chain.size(); ++i) {
+            int u = chain[i];
+            if (stop(u)) return false;
+            work += 1 + (long long)graphAdj[u].size();
+            for (int w : graphAdj[u])
+                if (seen[w] != stamp && (colors[w] == a || colors[w] == b)) {
+                    seen[w] = stamp;
+                    chain.push_back(w);
+                }
+        }
+        return true;
+    }
+
+    void flip(int a, int b) {
+        for (int u : chain) colors[u] ^= a ^ b; // a <-> b
+    }
+};
+
+// linear 5-coloring of a planar graph by reduction: remove a region of degree <= 4,
+// or contract a degree-5 region v with two non-adjacent neighbors x, y (y merges into
+// x, v goes); planar graphs always have one or the other, since five mutual neighbors
+// would be a K5. Undone in reverse, y takes x's color and v sees at most four colors.
+// Pairs are looked for among neighbors of degree <= PLANAR_LIGHT_DEGREE first, so a
+// step costs O(1) on maps. A graph that runs out of reducible regions is not planar;
+// its regions are then removed as they come, possibly with more colors.
+void contractionColoring(vector<int>& colors) {
+    // live adjacency is lazy: ids are resolved through rep[] (merged regions) and
+    // removed ones dropped when a list is compacted, which only happens to lists of
+    // regions with few live neighbors; deg[] is always exact
+    vector<vector<int>> live(graphAdj);
+    vector<int> rep(N), deg(N), seen(N, -1), tag(N, -1), work;
+    vector<char> gone(N, 0);
+    for (int v = 0; v < N; ++v) {
+        rep[v] = v;
+        deg[v] = (int)graphAdj[v].size();
+    }
+    auto find = [&](int u) {
+        while (rep[u] != u) u = rep[u] = rep[rep[u]];
+        return u;
+    };
+    auto compact = [&](int v) {
+        size_t n = 0;
+        for (int u : live[v]) {
+            u = find(u);
+            if (gone[u] || u == v || seen[u] == v) continue;
+            seen[u] = v;
+            live[v][n++] = u;
+        }
+        live[v].resize(n);
+        for (int u : live[v]) seen[u] = -1;
+    };
+    auto adjacent = [&](int a, int b) {
+        if (deg[a] > deg[b]) swap(a, b);
+        compact(a);
+        return find(b) == b && count(live[a].begin(), live[a].end(), b) > 0;
+    };
+    // a region that got lighter may now reduce, and so may its degree-5 neighbors
+    auto touched = [&](int u) {
+        if (gone[u] || deg[u] > PLANAR_LIGHT_DEGREE) return;
+        work.push_back(u);
+        compact(u);
+        for (int w : live[u])
+            if (deg[w] == 5) work.push_back(w);
+    };
+
+    struct Step { int v, x, y; }; // y == -1: v removed, else v dropped and y merged into x
+    vector<Step> steps;
+    steps.reserve(N);
+    int remaining = N;
+    auto remove = [&](int v) {
+        compact(v);
+        gone[v] = 1;
+        --remaining;
+        for (int nb : live[v]) --deg[nb];
+        steps.push_back({v, -1, -1});
+        for (int nb : live[v]) touched(nb);
+    };
+    auto contract = [&](int v, int x, int y) {
+        gone[v] = gone[y] = 1;
+        remaining -= 2;
+        for (int nb : live[v]) --deg[nb];
+        compact(x);
+        compact(y);
+        rep[y] = x;
+        for (int w : live[x]) tag[w] = y;
+        for (int w : live[y]) {
+            if (tag[w] == y) --deg[w]; // had both x and y
+            else live[x].push_back(w); // w's own list reaches x through rep[y]
+        }
+        deg[x] = (int)live[x].size();
+        steps.push_back({v, x, y});
+        for (int nb : live[v]) touched(nb);
+        for (int w : live[y]) touched(w);
+        touched(x);
+    };
+    // a degree-5 region with a non-adjacent pair among its neighbors of degree <= maxDeg
+    auto tryContract = [&](int v, int maxDeg) {
+        compact(v);
+        int cand[5], n = 0;
+        for (int w : live[v])
+            if (deg[w] <= maxDeg) cand[n++] = w;
+        for (int i = 0; i < n; ++i)
+            for (int j = i + 1; j < n; ++j)
+                if (!adjacent(cand[i], cand[j])) {
+                    contract(v, cand[i], cand[j]);
+                    return true;
+                }
+        return false;
+    };
+
+    vector<int> heavy; // degree-5 regions whose pairs all involve heavier neighbors
+    for (int v = N - 1; v >= 0; --v) work.push_back(v);
+    int next = 0;
+    while (remaining > 0) {
+        if (!work.empty()) {
+            int v = work.back();
+            work.pop_back();
+            if (gone[v]) continue;
+            if (deg[v] <= 4) remove(v);
+            else if (deg[v] == 5 && !tryContract(v, PLANAR_LIGHT_DEGREE)) heavy.push_back(v);
+        } else if (!heavy.empty()) {
+            int v = heavy.back();
+            heavy.pop_back();
+            if (!gone[v] && deg[v] == 5) tryContract(v, INT_MAX);
+        } else { // nothing reduces: not planar
+            while (gone[next]) ++next;
+            remove(next);
+        }
+    }
+
+    colors.assign(N, -1);
+    vector<int> mark(N + 1, -1); // mark[c] == v -> color c taken by a neighbor of v
+    for (auto it = steps.rbegin(); it != steps.rend(); ++it) {
+        if (it->y != -1) colors[it->y] = colors[it->x];
+        int v = it->v;
+        for (int nb : live[v]) mark[colors[nb]] = v; // all removed later, so colored
+        int c = 0;
+        while (mark[c] == v) ++c;
+        colors[v] = c;
+    }
+}
+
+// colors used; the coloring goes to colors
+int planarColoring(const CoreDecomposition& cd, vector<int>& colors) {
+    colors.assign(N, -1);
+    KempeChains kc(colors);
+    long long budget = 64LL * ((long long)N + adjOffset[N]);
+    vector<int> mark(N + 1, -1); // mark[c] == v -> color c taken by a neighbor of v
+
+    for (int v : cd.smallestLast()) {
+        if (kc.work >= budget) {
+            contractionColoring(colors);
+            break;
+        }
+        int colored = 0, holder[5] = {-1, -1, -1, -1, -1};
+        for (int nb : graphAdj[v]) {
+            if (colors[nb] == -1) continue;
+            ++colored;
+            mark[colors[nb]] = v;
+            if (colors[nb] < 5) holder[colors[nb]] = nb;
+        }
+        int c = 0;
+        while (mark[c] == v) ++c;
+        if (c == 5 && colored == 5) { // five neighbors, five colors
+            for (int a = 0; a < 5 && c == 5; ++a)
+                for (int b = a + 1; b < 5 && c == 5; ++b)
+                    if (kc.collect(holder[a], a, b, [&](int u) { return u == holder[b]; })) {
+                        kc.flip(a, b);
+                        c = a;
+                    }
+        }
+        colors[v] = c;
+    }
+
+    auto used = [&]() { return N ? *max_element(colors.begin(), colors.end()) + 1 : 0; };
+    if (used() <= 4) return used();
+
+    // push regions of color >= 4 into 0..3: take a free color, else free color a by
+    // flipping the {a, b} chain of every a-neighbor, unless one reaches a b-neighbor
+    kc.work = 0;
+    vector<int> nbMark(N, -1), high, left;
+    for (int v = 0; v < N; ++v)
+        if (colors[v] >= 4) high.push_back(v);
+    mt19937 rng(12345);
+    pair<int,int> pairs[12];
+    for (int a = 0, n = 0; a < 4; ++a)
+        for (int b = 0; b < 4; ++b)
+            if (a != b) pairs[n++] = {a, b};
+
+    for (int pass = 0; pass < PLANAR_KEMPE_PASSES && !high.empty() && kc.work < budget; ++pass) {
+        shuffle(high.begin(), high.end(), rng);
+        left.clear();
+        for (int v : high) {
+            for (int nb : graphAdj[v]) nbMark[nb] = v;
+            bool done = false;
+            for (int c = 0; c < 4 && !done; ++c) {
+                bool taken = false;
+                for (int nb : graphAdj[v]) taken |= colors[nb] == c;
+                if (!taken) { colors[v] = c; done = true; }
+            }
+            shuffle(begin(pairs), end(pairs), rng);
+            for (int p = 0; p < 12 && !done && kc.work < budget; ++p) {
+                int a = pairs[p].first, b = pairs[p].second;
+                bool ok = true;
+                for (int nb : graphAdj[v]) {
+                    if (colors[nb] != a) continue;
+                    // a reached b-neighbor would turn into a; flips so far keep the coloring proper
+                    ok = kc.collect(nb, a, b, [&](int u) { return nbMark[u] == v && colors[u] == b; });
+                    if (!ok) break;
+                    kc.flip(a, b);
+                }
+                if (ok) { colors[v] = a; done = true; }
+            }
+            if (!done) {
+                // still stuck: take a color only one neighbor holds and hand v's color
+                // to that neighbor if nothing else next to it has it, so the next
+                // round works on a new spot
+                int pick = -1, seenCount = 0, own = colors[v];
+                for (int a = 0; a < 4; ++a) {
+                    int holder = -1, holders = 0;
+                    for (int nb : graphAdj[v])
+                        if (colors[nb] == a) { holder = nb; ++holders; }
+                    if (holders != 1) continue;
+                    bool clash = false;
+                    for (int w : graphAdj[holder]) clash |= w != v && colors[w] == own;
+                    if (!clash && rng() % ++seenCount == 0) pick = holder;
+                }
+                if (pick != -1) {
+                    colors[v] = colors[pick];
+                    colors[pick] = own;
+                    v = pick;
+                }
+                left.push_back(v);
+            }
+        }
+        high.swap(left);
+    }
+    return used();
+}
+
+// exact maximum clique for small degeneracy d (up to 31): every clique is a region
+// plus some of its at most d neighbors that come earlier in smallest-last order, so
+// each region only needs a bitmask search over those.
+CliqueResult degeneracyClique(const CoreDecomposition& cd) {
+    CliqueResult res;
+    EarlierNeighbors en(cd);
+
+    vector<int> cur, best;
+    const int* cands = nullptr;
+    uint32_t adjMask[32];
+    // grows cur from cand (bits into cands) while it can still beat best
+    auto grow = [&](auto& self, uint32_t cand) -> void {
+        ++res.nodes;
+        if (cur.size() + __builtin_popcount(cand) <= best.size()) return;
+        if (!cand) { best = cur; return; }
+        int i = __builtin_ctz(cand);
+        cur.push_back(cands[i]);
+        self(self, cand & adjMask[i]);
+        cur.pop_back();
+        self(self, cand & ~(1u << i));
+    };
+
+    for (int v : en.order) {
+        int m = en.size(v);
+        if (m + 1 <= (int)best.size()) continue;
+        cands = en.begin(v);
+        for (int i = 0; i < m; ++i) {
+            adjMask[i] = 0;
+            for (int j = 0; j < m; ++j)
+                if (i != j && en.adjacent(cands[i], cands[j])) adjMask[i] |= 1u << j;
+        }
+        cur = {v};
+        grow(grow, m >= 32 ? ~0u : (1u << m) - 1);
+    }
+    res.clique = best;
+    res.exact = true;
+    return res;
+}
+
+// Buffered Output 
+// appends into a fixed buffer and hands full chunks to fwrite; numbers are
+// formatted in place with to_chars, no temporary strings
+struct BufferedWriter {
+    FILE* out;
+    vector<char> buf;
+    size_t len = 0;
+
+    explicit BufferedWriter(FILE* f, size_t capacity = 1 << 16) : out(f), buf(capacity) {}
+    ~BufferedWriter() { flush(); }
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    void flush() {
+        if (len) fwrite(buf.data(), 1, len, out);
+        len = 0;
+    }
+    void reserve(size_t n) { if (len + n > buf.size()) flush(); }
+
+    void write(const char* s, size_t n) {
+        if (n > buf.size()) { flush(); fwrite(s, 1, n, out); return; }
+        reserve(n);
+        memcpy(buf.data() + len, s, n);
+        len += n;
+    }
+
+    BufferedWriter& operator<<(char c) { reserve(1); buf[len++] = c; return *this; }
+    BufferedWriter& operator<<(const char* s) { write(s, strlen(s)); return *this; }
+    BufferedWriter& operator<<(const string& s) { write(s.data(), s.size()); return *this; }
+
+    template <class T, class = enable_if_t<is_integral_v<T> && !is_same_v<T, char> && !is_same_v<T, bool>>>
+    BufferedWriter& operator<<(T v) {
+        reserve(24);
+        len = to_chars(buf.data() + len, buf.data() + buf.size(), v).ptr - buf.data();
+        return *this;
+    }
+
+    BufferedWriter& operator<<(double v) { // fixed, 3 decimals
+        reserve(48);
+        len = to_chars(buf.data() + len, buf.data() + buf.size(), v, chars_format::fixed, 3).ptr - buf.data();
+        return *this;
+    }
+};
+
+// Graph Visualization 
+struct Coord { int x,y; };
+
+// calls f(u, v) once per edge, u < v
+template <class F>
+void forEachEdge(F f) {
+    for (int u = 0; u < N; ++u)
+        for (int v : graphAdj[u])
+            if (v > u) f(u, v);
+}
+
+// Force-Directed Layout 
+// Fruchterman-Reingold: edges pull with d^2/k, every pair pushes with k^2/d. The
+// pushes come from a Barnes-Hut quadtree (a cell of side s at distance d counts as
+// one body when s/d < BARNES_HUT_THETA), so an iteration is O(N log N); forces are
+// computed in parallel over regions. Starts from a fixed seed, so runs repeat.
+int LAYOUT_ITERATIONS = 100;
+int LAYOUT_THREADS = max(1u, thread::hardware_concurrency());
+double BARNES_HUT_THETA = 0.8;
+
+// splits [0, n) into contiguous chunks and runs fn(begin, end) on up to `threads`
+// threads; small ranges stay on the caller's thread
+template <class F>
+void parallelFor(int n, int threads, F fn) {
+    threads = max(1, min(threads, n / 2048));
+    if (threads == 1) { fn(0, n); return; }
+    vector<thread> pool;
+    int chunk = (n + threads - 1) / threads;
+    auto worker = [&fn](int t, int b, int e) {
+        TraceScope trace("worker", t);
+        fn(b, e);
+    };
+    for (int t = 1; t < threads; ++t) {
+        int b = t * chunk, e = min(n, b + chunk);
+        if (b < e) pool.emplace_back(worker, t, b, e);
+    }
+    worker(0, 0, min(n, chunk));
+    for (auto& th : pool) th.join();
+}
+
+struct QuadTree {
+    static constexpr int MAX_DEPTH = 40; // coincident points share a leaf past this
+    struct Cell {
+        double cx = 0, cy = 0, mass = 0; // center of mass
+        double x0 = 0, y0 = 0, size = 0; // square covered
+        int child[4] = {-1, -1, -1, -1};
+        int body = -1;
+        bool leaf = true;
+    };
+    vector<Cell> cells;
+    const double* px = nullptr;
+    const double* py = nullptr;
+
+    int quadrant(const Cell& c, int i) const {
+        double h = c.size / 2;
+        return (px[i] >= c.x0 + h ? 1 : 0) + (py[i] >= c.y0 + h ? 2 : 0);
+    }
+
+    int addChild(int c, int q, int body) {
+        Cell child;
+        child.size = cells[c].size / 2;
+        child.x0 = cells[c].x0 + (q & 1 ? child.size : 0);
+        child.y0 = cells[c].y0 + (q & 2 ? child.size : 0);
+        child.body = body;
+        child.cx = px[body]; child.cy = py[body]; child.mass = 1;
+        cells.push_back(child);
+        cells[c].child[q] = (int)cells.size() - 1;
+        return cells[c].child[q];
+    }
+
+    void insert(int i) {
+        int c = 0;
+        for (int depth = 0; ; ++depth) {
+            if (cells[c].mass == 0) {
+                cells[c].body = i; cells[c].cx = px[i]; cells[c].cy = py[i]; cells[c].mass = 1;
+                return;
+            }
+            if (cells[c].leaf && depth < MAX_DEPTH) { // split, push the resident body down
+                int old = cells[c].body;
+                cells[c].body = -1;
+                cells[c].leaf = false;
+                addChild(c, quadrant(cells[c], old), old);
+            }
+            Cell& cell = cells[c];
+            cell.cx = (cell.cx * cell.mass + px[i]) / (cell.mass + 1);
+            cell.cy = (cell.cy * cell.mass + py[i]) / (cell.mass + 1);
+            cell.mass += 1;
+            if (cell.leaf) return; // depth limit, aggregated
+            int q = quadrant(cell, i);
+            if (cell.child[q] == -1) { addChild(c, q, i); return; }
+            c = cell.child[q];
+        }
+    }
+
+    void build(const vector<double>& xs, const vector<double>& ys) {
+        px = xs.data(); py = ys.data();
+        int n = (int)xs.size();
+        double minX = *min_element(xs.begin(), xs.end()), maxX = *max_element(xs.begin(), xs.end());
+        double minY = *min_element(ys.begin(), ys.end()), maxY = *max_element(ys.begin(), ys.end());
+        cells.clear();
+        cells.reserve(2 * n);
+        Cell root;
+        root.x0 = minX; root.y0 = minY;
+        root.size = max(maxX - minX, maxY - minY) * 1.0001 + 1e-9;
+        cells.push_back(root);
+        for (int i = 0; i < n; ++i) insert(i);
+    }
+
+    // summed repulsion k2 * m * d / |d|^2 on body i
+    void repulsion(int i, double k2, double theta2, double& fx, double& fy, vector<int>& stack) const {
+        stack.clear();
+        stack.push_back(0);
+        while (!stack.empty()) {
+            const Cell& c = cells[stack.back()];
+            stack.pop_back();
+            if (c.mass == 0 || c.body == i) continue;
+            double dx = px[i] - c.cx, dy = py[i] - c.cy;
+            double d2 = dx * dx + dy * dy;
+            if (c.leaf || c.size * c.size < theta2 * d2) {
+                if (d2 < 1e-12) { dx = 1e-3 * ((i & 1) ? 1 : -1); dy = 1e-3; d2 = 2e-6; } // coincident
+                fx += dx * c.mass * k2 / d2;
+                fy += dy * c.mass * k2 / d2;
+                continue;
+            }
+            for (int q = 0; q < 4; ++q)
+                if (c.child[q] != -1) stack.push_back(c.child[q]);
+        }
+    }
+};
+
+// region positions in [0, width) x [0, height)
+vector<Coord> generateCoordinates(int width, int height) {
+    vector<Coord> coords(N);
+    if (N == 0) return coords;
+    double side = sqrt((double)N); // layout box, ideal edge length 1
+    vector<double> xs(N), ys(N), dx(N), dy(N);
+    mt19937 rng(12345);
+    uniform_real_distribution<double> dist(0.0, side);
+    for (int i = 0; i < N; ++i) { xs[i] = dist(rng); ys[i] = dist(rng); }
+
+    const double k = 1.0, k2 = k * k, theta2 = BARNES_HUT_THETA * BARNES_HUT_THETA;
+    double temp = side / 10;
+    QuadTree tree;
+    for (int it = 0; it < LAYOUT_ITERATIONS; ++it) {
+        TraceScope trace("layout iteration", it);
+        tree.build(xs, ys);
+        parallelFor(N, LAYOUT_THREADS, [&](int begin, int end){
+            vector<int> stack;
+            for (int i = begin; i < end; ++i) {
+                double fx = 0, fy = 0;
+                tree.repulsion(i, k2, theta2, fx, fy, stack);
+                for (int nb : graphAdj[i]) {
+                    double ex = xs[i] - xs[nb], ey = ys[i] - ys[nb];
+                    double d = sqrt(ex * ex + ey * ey);
+                    fx -= ex * d / k;
+                    fy -= ey * d / k;
+                }
+                dx[i] = fx; dy[i] = fy;
+            }
+        });
+        for (int i = 0; i < N; ++i) { // move at most temp
+            double len = sqrt(dx[i] * dx[i] + dy[i] * dy[i]);
+            if (len > temp) { dx[i] *= temp / len; dy[i] *= temp / len; }
+            xs[i] += dx[i];
+            ys[i] += dy[i];
+        }
+        temp = max(temp * 0.95, side / 1000);
+    }
+
+    // fit into the target box
+    double minX = *min_element(xs.begin(), xs.end()), maxX = *max_element(xs.begin(), xs.end());
+    double minY = *min_element(ys.begin(), ys.end()), maxY = *max_element(ys.begin(), ys.end());
+    double sx = maxX > minX ? (width - 1) / (maxX - minX) : 0;
+    double sy = maxY > minY ? (height - 1) / (maxY - minY) : 0;
+    for (int i = 0; i < N; ++i)
+        coords[i] = {(int)lround((xs[i] - minX) * sx), (int)lround((ys[i] - minY) * sy)};
+    return coords;
+}
+
+// Spectral Bound 
+// Hoffman: chi >= 1 - lambdaMax / lambdaMin for the adjacency eigenvalues. Both come
+// from a Lanczos run on graphAdj (SpMV spread over LAYOUT_THREADS with parallelFor,
+// fixed random start). The extreme Ritz values of the tridiagonal T are found by
+// Sturm bisection. The top one never exceeds lambdaMax; the bottom one is lowered by
+// its residual bound, which covers its error once Lanczos has reached the bottom of
+// the spectrum (a random start reaches it short of exact orthogonality). So the
+// bound errs low, but only once both Ritz values have settled (or the Krylov space
+// closed): a run cut short by LANCZOS_STEPS, the search deadline, or because even
+// lambdaMax <= max degree can't lift the bound above `target` reports bound 1.
+// O(steps * E).
+bool USE_SPECTRAL_BOUND = true;
+int LANCZOS_STEPS = 120;
+
+struct SpectralBound {
+    double lambdaMax = 0, lambdaMin = 0;
+    int steps = 0;
+    bool converged = false;     // Ritz values settled, bound is meaningful
+    int bound = 1;              // ceil of the Hoffman bound, at least 1
+};
+
+// eigenvalues of T (alpha on the diagonal, beta[i] between i and i + 1) below x
+int sturmCount(const vector<double>& alpha, const vector<double>& beta, int m, double x) {
+    int count = 0;
+    double d = 1;
+    for (int i = 0; i < m; ++i) {
+        double b2 = i ? beta[i - 1] * beta[i - 1] : 0;
+        d = alpha[i] - x - (i ? b2 / d : 0);
+        if (d == 0) d = -1e-300;
+        if (d < 0) ++count;
+    }
+    return count;
+}
+
+// the i-th smallest eigenvalue of T (0-based) by bisection inside [lo, hi]
+double tridiagonalEigenvalue(const vector<double>& alpha, const vector<double>& beta, int m, int i, double lo, double hi) {
+    for (int it = 0; it < 200 && hi - lo > 1e-12 * max(1.0, fabs(lo) + fabs(hi)); ++it) {
+        double mid = (lo + hi) / 2;
+        if (sturmCount(alpha, beta, m, mid) > i) hi = mid;
+        else lo = mid;
+    }
+    return (lo + hi) / 2;
+}
+
+// |last component| of the unit eigenvector of T for eigenvalue theta (forward recurrence)
+double ritzTail(const vector<double>& alpha, const vector<double>& beta, int m, double theta) {
+    vector<double> s(m);
+    s[0] = 1;
+    for (int i = 0; i + 1 < m; ++i) {
+        double next = (theta - alpha[i]) * s[i] - (i ? beta[i - 1] * s[i - 1] : 0);
+        s[i + 1] = beta[i] != 0 ? next / beta[i] : 0;
+        if (!isfinite(s[i + 1])) return 1; // unstable: assume the worst
+    }
+    double norm = 0;
+    for (double x : s) norm += x * x;
+    return fabs(s[m - 1]) / sqrt(norm);
+}
+
+SpectralBound hoffmanBound(int target = 0) {
+    SpectralBound r;
+    if (N == 0 || adjOffset[N] == 0) return r;
+    auto spmv = [&](const vector<double>& x, vector<double>& y) {
+        parallelFor(N, LAYOUT_THREADS, [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                double sum = 0;
+                for (int nb : graphAdj[i]) sum += x[nb];
+                y[i] = sum;
+            }
+        });
+    };
+    auto dot = [](const vector<double>& a, const vector<double>& b) {
+        double s = 0;
+        for (size_t i = 0; i < a.size(); ++i) s += a[i] * b[i];
+        return s;
+    };
+
+    vector<double> q(N), prev(N, 0.0), w(N), alpha, beta;
+    mt19937 rng(12345);
+    uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (double& x : q) x = dist(rng);
+    double norm = sqrt(dot(q, q));
+    for (double& x : q) x /= norm;
+
+    int maxDeg = 0;
+    for (int v = 0; v < N; ++v) maxDeg = max(maxDeg, (int)graphAdj[v].size());
+    double lo = -maxDeg - 1.0, hi = maxDeg + 1.0; // Gershgorin
+    double top = 0, bottom = 0, lastTop = 0, lastBottom = 0, betaLast = 0;
+    int m = 0;
+    for (int step = 0; step < min(N, LANCZOS_STEPS); ++step) {
+        spmv(q, w);
+        double a = dot(w, q);
+        double b = beta.empty() ? 0 : beta.back();
+        for (int i = 0; i < N; ++i) w[i] -= a * q[i] + b * prev[i];
+        double c = dot(w, q); // one pass of local reorthogonalization
+        for (int i = 0; i < N; ++i) w[i] -= c * q[i];
+        alpha.push_back(a + c);
+        m = (int)alpha.size();
+        betaLast = sqrt(dot(w, w));
+
+        bool breakdown = betaLast < 1e-10;
+        if ((m % 10 == 0) || breakdown || m == min(N, LANCZOS_STEPS)) {
+            top = tridiagonalEigenvalue(alpha, beta, m, m - 1, lo, hi);
+            bottom = tridiagonalEigenvalue(alpha, beta, m, 0, lo, hi);
+            bool settled = m > 10 && fabs(top - lastTop) < 1e-9 * (1 + fabs(top)) &&
+                           fabs(bottom - lastBottom) < 1e-9 * (1 + fabs(bottom));
+            // Ritz values only spread out, so this caps what the remaining steps can give
+            bool hopeless = bottom < 0 && ceil(1 + maxDeg / -bottom - 1e-9) <= target;
+            bool late = TIME_LIMIT_SEC > 0 && chrono::steady_clock::now() > searchDeadline;
+            lastTop = top;
+            lastBottom = bottom;
+            r.converged = settled || breakdown;
+            if (settled || breakdown || hopeless || late) break;
+        }
+        beta.push_back(betaLast);
+        swap(prev, q);
+        for (int i = 0; i < N; ++i) q[i] = w[i] / betaLast;
+    }
+
+    r.steps = m;
+    r.lambdaMax = top;
+    // some eigenvalue lies within betaLast * |s_m| of the Ritz value
+    r.lambdaMin = max(lo, bottom - betaLast * ritzTail(alpha, beta, m, bottom) - 1e-9 * (1 + fabs(bottom)));
+    if (r.converged && r.lambdaMin < 0) r.bound = max(1, (int)ceil(1 - r.lambdaMax / r.lambdaMin - 1e-9));
+    return r;
+}
+
+// bulk listings go through one buffered writer; VERBOSE = false leaves only the result line
+bool VERBOSE = true;
+
+void printAdjacencyList() {
+    cout << flush;
+    BufferedWriter out(stdout, 1 << 20);
+    out << "\nAdjacency list: \n";
+    for (int i = 0; i < N; ++i) {
+        out << "Region " << i << ": ";
+        for (int nb : graphAdj[i]) out << nb << ' ';
+        out << '\n';
+    }
+}
+
+void printSolution(const vector<int>& colors) {
+    cout << flush;
+    BufferedWriter out(stdout, 1 << 20);
+    for (int i = 0; i < N; ++i) out << "Region " << i << " -> Color " << colors[i] << '\n';
+}
+
+// canvas grows with N: nodes sit in grid slots near their force-directed position
+// (O(1) occupancy) and drawing costs one step per edge cell. Skipped above DIAGRAM_MAX_NODES.
+int DIAGRAM_MAX_NODES = 200;
+
+void printGraphDiagram() {
+    cout << "\nGraph diagram: \n\n";
+    if (N > DIAGRAM_MAX_NODES) {
+        cout << "(skipped, " << N << " regions > " << DIAGRAM_MAX_NODES << ")\n\n";
+        return;
+    }
+
+    // slot = widest label "(N-1)" plus a gap, two rows tall; about 3 slots per node
+    char num[16];
+    int labelWidth = (int)(to_chars(num, num + sizeof num, max(0, N - 1)).ptr - num) + 2;
+    int slotW = labelWidth + 1, slotH = 2;
+    int gridCols = max((int)ceil(sqrt(3.0 * N) * 1.5), 60 / slotW);
+    int gridRows = max((3 * N + gridCols - 1) / gridCols, 10);
+    const int canvasRows = gridRows * slotH;
+    const int canvasCols = gridCols * slotW;
+    vector<char> canvas((size_t)canvasRows * canvasCols, ' ');
+    auto cell = [&](int r, int c) -> char& { return canvas[(size_t)r * canvasCols + c]; };
+
+    // Layout positions snapped to the nearest free slot (rings of growing radius)
+    struct Pos { int r, c; };
+    vector<Pos> pos(N);
+    vector<char> taken((size_t)gridRows * gridCols, 0);
+    vector<Coord> layout = generateCoordinates(gridCols, gridRows);
+    for (int i = 0; i < N; ++i) {
+        int sr = -1, sc = -1;
+        for (int rad = 0; sr == -1; ++rad) {
+            for (int r = layout[i].y - rad; r <= layout[i].y + rad && sr == -1; ++r) {
+                if (r < 0 || r >= gridRows) continue;
+                for (int c = layout[i].x - rad; c <= layout[i].x + rad; ++c) {
+                    if (c < 0 || c >= gridCols) continue;
+                    if (max(abs(r - layout[i].y), abs(c - layout[i].x)) != rad) continue;
+                    if (!taken[(size_t)r * gridCols + c]) { sr = r; sc = c; break; }
+                }
+            }
+        }
+        taken[(size_t)sr * gridCols + sc] = 1;
+        pos[i] = {sr * slotH, sc * slotW};
+    }
+
+    // Draw edges
+    auto setCharSafe = [&](int r, int c, char ch){
+        if (r<0 || r>=canvasRows || c<0 || c>=canvasCols) return;
+        char cur = cell(r, c);
+        if (cur=='(' || cur==')' || (cur>='0' && cur<='9')) return;
+        cell(r, c) = ch;
+    };
+
+    forEachEdge([&](int u, int v){
+        int r1 = pos[u].r, c1 = pos[u].c+1; // center of node
+        int r2 = pos[v].r, c2 = pos[v].c+1;
+        int cr = r1, cc = c1;
+        while (cr != r2 || cc != c2) {
+            int dr = (r2>cr)?1:(r2<cr)?-1:0;
+            int dc = (c2>cc)?1:(c2<cc)?-1:0;
+            if (dr==0 && dc!=0) setCharSafe(cr,cc,'-');
+            else if (dc==0 && dr!=0) setCharSafe(cr,cc,'|');
+            else if (dr==dc) setCharSafe(cr,cc,'\\');
+            else setCharSafe(cr,cc,'/');
+            if (cr!=r2) cr+=dr;
+            if (cc!=c2) cc+=dc;
+        }
+    });
+
+    // Draw nodes
+    for (int i=0;i<N;i++) {
+        num[0] = '(';
+        char* end = to_chars(num + 1, num + sizeof num - 1, i).ptr;
+        *end++ = ')';
+        int r=pos[i].r, c=pos[i].c;
+        for (int j=0;j<(int)(end-num);j++) {
+            if (c+j<canvasCols) cell(r, c+j)=num[j];
+        }
+    }
+
+    // Print canvas, trailing blanks trimmed
+    cout << flush;
+    BufferedWriter out(stdout, 1 << 20);
+    for (int r = 0; r < canvasRows; ++r) {
+        const char* line = &canvas[(size_t)r * canvasCols];
+        int len = canvasCols;
+        while (len > 0 && line[len - 1] == ' ') --len;
+        out.write(line, len);
+        out << '\n';
+    }
+    out << '\n';
+}
+// Export (SVG / DOT) 
+// colored graph streamed straight to a file; empty path = no export
+string SVG_OUTPUT, DOT_OUTPUT;
+
+// spread k hues around the wheel (golden angle), color -1 is gray
+void colorHSV(int color, double& h, double& sat, double& val) {
+    if (color < 0) { h = 0; sat = 0; val = 0.75; return; }
+    h = fmod(color * 0.618033988749895, 1.0);
+    sat = 0.55 + 0.15 * (color % 3) / 2.0;
+    val = 0.95 - 0.1 * (color % 2);
+}
+
+bool exportDot(const string& path, const vector<int>& colors) {
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) return false;
+    {
+        BufferedWriter w(f);
+        w << "graph G {\n  node [style=filled, shape=circle];\n";
+        for (int i = 0; i < N; ++i) {
+            double h, sat, val;
+            colorHSV(colors[i], h, sat, val);
+            w << "  " << i << " [fillcolor=\"" << h << ' ' << sat << ' ' << val << "\"];\n";
+        }
+        forEachEdge([&](int u, int v){ w << "  " << u << " -- " << v << ";\n"; });
+        w << "}\n";
+    }
+    return fclose(f) == 0;
+}
+
+bool exportSvg(const string& path, const vector<int>& colors, const vector<Coord>& coords, int width, int height) {
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) return false;
+    {
+        BufferedWriter w(f);
+        const int margin = 10;
+        const bool labels = N <= 1000;
+        w << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width + 2 * margin
+          << "\" height=\"" << height + 2 * margin << "\">\n";
+        w << "<g transform=\"translate(" << margin << ',' << margin << ")\">\n";
+        w << "<g stroke=\"#999\" stroke-width=\"1\">\n";
+        forEachEdge([&](int u, int v){
+            w << "<line x1=\"" << coords[u].x << "\" y1=\"" << coords[u].y
+              << "\" x2=\"" << coords[v].x << "\" y2=\"" << coords[v].y << "\"/>\n";
+        });
+        w << "</g>\n<g stroke=\"#333\" stroke-width=\"0.5\">\n";
+        for (int i = 0; i < N; ++i) {
+            double h, sat, val;
+            colorHSV(colors[i], h, sat, val);
+            // hsv -> hsl for CSS
+            double l = val * (1 - sat / 2);
+            double sl = (l == 0 || l == 1) ? 0 : (val - l) / min(l, 1 - l);
+            w << "<circle cx=\"" << coords[i].x << "\" cy=\"" << coords[i].y << "\" r=\"5\" fill=\"hsl("
+              << (int)(h * 360) << ',' << (int)(sl * 100) << "%," << (int)(l * 100) << "%)\"/>\n";
+        }
+        w << "</g>\n";
+        if (labels) {
+            w << "<g font-family=\"monospace\" font-size=\"9\">\n";
+            for (int i = 0; i < N; ++i)
+                w << "<text x=\"" << coords[i].x + 6 << "\" y=\"" << coords[i].y - 6 << "\">" << i << "</text>\n";
+            w << "</g>\n";
+        }
+        w << "</g>\n</svg>\n";
+    }
+    return fclose(f) == 0;
+}
+// Result Output 
+// one record per run for pipelines. JSON: a single line, written field by field.
+// BINARY (little-endian): "MCR2", u32 regions, u32 edges, u32 chi, u32 lower bound,
+// u32 upper bound, u8 clique exact, u8 timed out, u32 probe count, per probe {u32 k,
+// u8 status (0 unsat, 1 sat, 2 timed out), f64 ms, u64 nodes}, f64 total ms, u8 counted
+// (--count), u64 count, u8 count overflowed, u8 count incomplete, u8 bytes per color
+// (1 or 4), the colors, u32 phase count (0 without --perf), per phase {u8 name length,
+// name, i32 k, f64 ms, u8 counted, u64 cycles, u64 instructions, u64 cache misses,
+// u64 branch misses}.
+enum class OutputFormat { TEXT, JSON, BINARY };
+OutputFormat OUTPUT_FORMAT = OutputFormat::TEXT;
+string RESULT_OUTPUT; // file for JSON/BINARY, empty = stdout
+
+enum class ProbeStatus : uint8_t { UNSAT, SAT, TIMED_OUT };
+
+struct ProbeRecord {
+    int k;
+    ProbeStatus status;
+    double ms;
+    long long nodes;
+};
+
+struct RunReport {
+    int regions = 0;
+    long long edges = 0;
+    int chi = -1;
+    int lowerBound = 0, upperBound = 0;
+    bool cliqueExact = false;
+    bool timedOut = false;      // chi is then only an upper bound
+    vector<ProbeRecord> probes;
+    double totalMs = 0;
+    bool counted = false;       // --count ran; count is then a lower bound if either flag is set
+    uint64_t count = 0;
+    bool countOverflowed = false, countIncomplete = false;
+    const vector<int>* colors = nullptr;
+    const vector<PhaseRecord>* phases = nullptr; // --perf only
+};
+
+void emitJson(BufferedWriter& w, const RunReport& r) {
+    w << "{\"regions\":" << r.regions << ",\"edges\":" << r.edges << ",\"chi\":" << r.chi
+      << ",\"lower_bound\":" << r.lowerBound << ",\"upper_bound\":" << r.upperBound
+      << ",\"clique_exact\":" << (r.cliqueExact ? "true" : "false")
+      << ",\"timed_out\":" << (r.timedOut ? "true" : "false") << ",\"probes\":[";
+    for (size_t i = 0; i < r.probes.size(); ++i) {
+        const ProbeRecord& p = r.probes[i];
+        const char* status = p.status == ProbeStatus::SAT ? "sat" : p.status == ProbeStatus::UNSAT ? "unsat" : "timed_out";
+        w << (i ? ",{" : "{") << "\"k\":" << p.k << ",\"status\":\"" << status
+          << "\",\"ms\":" << p.ms << ",\"nodes\":" << p.nodes << '}';
+    }
+    w << "],\"total_ms\":" << r.totalMs;
+    if (r.counted)
+        w << ",\"count\":" << r.count << ",\"count_overflowed\":" << (r.countOverflowed ? "true" : "false")
+          << ",\"count_incomplete\":" << (r.countIncomplete ? "true" : "false");
+    w << ",\"colors\":[";
+    if (r.colors)
+        for (size_t i = 0; i < r.colors->size(); ++i) w << (i ? "," : "") << (*r.colors)[i];
+    w << ']';
+    if (r.phases && PERF_COUNTERS) {
+        w << ",\"phases\":[";
+        for (size_t i = 0; i < r.phases->size(); ++i) {
+            const PhaseRecord& p = (*r.phases)[i];
+            w << (i ? ",{" : "{") << "\"phase\":\"" << p.phase << "\",\"k\":" << p.k << ",\"ms\":" << p.ms;
+            if (p.counted)
+                w << ",\"cycles\":" << p.cycles << ",\"instructions\":" << p.instructions
+                  << ",\"cache_misses\":" << p.cacheMisses << ",\"branch_misses\":" << p.branchMisses;
+            w << '}';
+        }
+        w << ']';
+    }
+    w << "}\n";
+}
+
+template <class T>
+void emitRaw(BufferedWriter& w, T v) { w.write((const char*)&v, sizeof v); }
+
+void emitBinary(BufferedWriter& w, const RunReport& r) {
+    w.write("MCR2", 4);
+    emitRaw<uint32_t>(w, r.regions);
+    emitRaw<uint32_t>(w, (uint32_t)r.edges);
+    emitRaw<uint32_t>(w, (uint32_t)r.chi);
+    emitRaw<uint32_t>(w, r.lowerBound);
+    emitRaw<uint32_t>(w, r.upperBound);
+    emitRaw<uint8_t>(w, r.cliqueExact);
+    emitRaw<uint8_t>(w, r.timedOut);
+    emitRaw<uint32_t>(w, (uint32_t)r.probes.size());
+    for (const ProbeRecord& p : r.probes) {
+        emitRaw<uint32_t>(w, p.k);
+        emitRaw<uint8_t>(w, (uint8_t)p.status);
+        emitRaw<double>(w, p.ms);
+        emitRaw<uint64_t>(w, p.nodes);
+    }
+    emitRaw<double>(w, r.totalMs);
+    emitRaw<uint8_t>(w, r.counted);
+    emitRaw<uint64_t>(w, r.count);
+    emitRaw<uint8_t>(w, r.countOverflowed);
+    emitRaw<uint8_t>(w, r.countIncomplete);
+    size_t n = r.colors ? r.colors->size() : 0;
+    uint8_t width = r.chi <= 256 ? 1 : 4;
+    emitRaw<uint8_t>(w, width);
+    for (size_t i = 0; i < n; ++i) {
+        if (width == 1) emitRaw<uint8_t>(w, (uint8_t)(*r.colors)[i]);
+        else emitRaw<int32_t>(w, (*r.colors)[i]);
+    }
+    size_t phases = r.phases && PERF_COUNTERS ? r.phases->size() : 0;
+    emitRaw<uint32_t>(w, (uint32_t)phases);
+    for (size_t i = 0; i < phases; ++i) {
+        const PhaseRecord& p = (*r.phases)[i];
+        emitRaw<uint8_t>(w, (uint8_t)p.phase.size());
+        w.write(p.phase.data(), p.phase.size());
+        emitRaw<int32_t>(w, p.k);
+        emitRaw<double>(w, p.ms);
+        emitRaw<uint8_t>(w, p.counted);
+        emitRaw<uint64_t>(w, p.cycles);
+        emitRaw<uint64_t>(w, p.instructions);
+        emitRaw<uint64_t>(w, p.cacheMisses);
+        emitRaw<uint64_t>(w, p.branchMisses);
+    }
+}
+
+// per-phase table for the text output; IPC and misses per 1000 instructions tell
+// memory-bound phases (low IPC, many cache misses) from branch-bound ones
+void printPhases() {
+    BufferedWriter w(stdout);
+    w << "\nPhase counters";
+    if (!profiler.opened) w << " unavailable (" << profiler.unavailable << "), wall times only";
+    w << ":\n";
+    for (const PhaseRecord& p : profiler.records) {
+        w << "  " << p.phase;
+        if (p.k >= 0) w << " k=" << p.k;
+        w << ": " << p.ms << " ms";
+        if (p.counted) {
+            double kInstr = max<double>(1.0, (double)p.instructions) / 1000.0;
+            w << ", " << p.cycles << " cycles, " << p.instructions << " instructions, IPC "
+              << (p.cycles ? (double)p.instructions / (double)p.cycles : 0.0) << ", "
+              << (double)p.cacheMisses / kInstr << " cache / " << (double)p.branchMisses / kInstr
+              << " branch misses per 1k instructions";
+        }
+        w << '\n';
+    }
+}
+
+// merges the rings into one Chrome trace JSON file; all traced threads must be done
+bool writeTrace(const string& path) {
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) return false;
+    {
+        BufferedWriter w(f);
+        w << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        for (const auto& ring : traceRings) {
+            w << (first ? "" : ",") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->tid
+              << ",\"args\":{\"name\":\"" << (ring->tid ? "worker " : "main") ;
+            if (ring->tid) w << ring->tid;
+            w << "\"}}";
+            first = false;
+            uint64_t cap = ring->events.size();
+            uint64_t from = ring->pushed > cap ? ring->pushed - cap : 0;
+            if (from) w << ",{\"name\":\"dropped\",\"ph\":\"i\",\"s\":\"t\",\"ts\":0,\"pid\":1,\"tid\":"
+                        << ring->tid << ",\"args\":{\"events\":" << from << "}}";
+            for (uint64_t i = from; i < ring->pushed; ++i) {
+                const TraceEvent& e = ring->events[i % cap];
+                w << ",{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->tid
+                  << ",\"ts\":" << e.startNs / 1000.0 << ",\"dur\":" << e.durNs / 1000.0;
+                if (e.arg >= 0) w << ",\"args\":{\"arg\":" << e.arg << '}';
+                w << '}';
+            }
+        }
+        w << "]}\n";
+    }
+    return fclose(f) == 0;
+}
+
+bool emitReport(const RunReport& r) {
+    FILE* f = RESULT_OUTPUT.empty() ? stdout : fopen(RESULT_OUTPUT.c_str(), OUTPUT_FORMAT == OutputFormat::BINARY ? "wb" : "w");
+    if (!f) return false;
+    {
+        BufferedWriter w(f);
+        if (OUTPUT_FORMAT == OutputFormat::JSON) emitJson(w, r);
+        else emitBinary(w, r);
+    }
+    if (f == stdout) return fflush(f) == 0;
+    return fclose(f) == 0;
+}
+
+
+// Verification 
+// O(N + E) check of a complete coloring: every region holds a color in [0, k) and no
+// edge joins two equal colors. On failure *badRegion is the first offending region.
+bool verifyColoring(const vector<vector<int>>& adj, const vector<int>& colors, int k, int* badRegion = nullptr) {
+    int n = (int)adj.size();
+    auto fail = [&](int v) {
+        if (badRegion) *badRegion = v;
+        return false;
+    };
+    if ((int)colors.size() != n) return fail(-1);
+    for (int u = 0; u < n; ++u) {
+        if (colors[u] < 0 || colors[u] >= k) return fail(u);
+        for (int v : adj[u])
+            if (colors[v] == colors[u]) return fail(u);
+    }
+    return true;
+}
+
+// Differential Fuzzing 
+// runs seeded random graphs (1..FUZZ_MAX_NODES regions, density 10..90%) through every
+// engine. The reference chi comes from the generic backtrack() with AC-3, MRV and
+// natural values; each other configuration must reach the same chi with a verified
+// coloring. The fast paths, core peeling, bounds (clique, greedy, Hoffman), planar
+// coloring, counting, enumeration and the chromatic polynomial are checked against
+// it too. Graph i uses seed base + i, so a failure replays with --seed S --nodes N
+// --density D. A few fixed graphs then reach what small random ones cannot: a hub
+// above 255 neighbors for the 16-bit kernel counters, k above 15 and 255 for the
+// 8- and 16-bit packed colors.
+int FUZZ_RUNS = 0;
+int FUZZ_MAX_NODES = 10;
+
+struct FuzzConfig {
+    const char* name;
+    bool ac3, kernels;
+    ValueOrder valueOrder;
+    VarOrder varOrder;
+    double wdegDecay;
+    bool task;              // resumable SearchTask instead of solveWithKColors
+    int countBytes = 0;     // KERNEL_COUNT_BYTES
+    int colorBits = 0;      // PACKED_COLOR_BITS
+};
+
+const FuzzConfig FUZZ_REFERENCE = {"backtrack", true, false, ValueOrder::NATURAL, VarOrder::MRV, 1.0, false};
+const FuzzConfig FUZZ_CONFIGS[] = {
+    {"kernels",         true,  true,  ValueOrder::NATURAL, VarOrder::MRV,      1.0,  false},
+    {"no-ac3",          false, false, ValueOrder::NATURAL, VarOrder::MRV,      1.0,  false},
+    {"no-ac3 kernels",  false, true,  ValueOrder::NATURAL, VarOrder::MRV,      1.0,  false},
+    {"lcv",             true,  false, ValueOrder::LCV,     VarOrder::MRV,      1.0,  false},
+    {"popular",         true,  false, ValueOrder::POPULAR, VarOrder::MRV,      1.0,  false},
+    {"phase",           true,  false, ValueOrder::PHASE,   VarOrder::MRV,      1.0,  false},
+    {"domwdeg",         true,  false, ValueOrder::NATURAL, VarOrder::DOM_WDEG, 1.0,  false},
+    {"domwdeg decay",   false, false, ValueOrder::LCV,     VarOrder::DOM_WDEG, 0.75, false},
+    {"degeneracy",      true,  false, ValueOrder::NATURAL, VarOrder::DEGENERACY, 1.0, false},
+    {"degeneracy lcv",  false, false, ValueOrder::LCV,     VarOrder::DEGENERACY, 1.0, false},
+    {"task",            false, false, ValueOrder::NATURAL, VarOrder::MRV,      1.0,  true},
+    {"kernels 16-bit",  true,  true,  ValueOrder::NATURAL, VarOrder::MRV,      1.0,  false, 2},
+    {"kernels 32-bit",  false, true,  ValueOrder::NATURAL, VarOrder::MRV,      1.0,  false, 4},
+    {"colors 8-bit",    true,  false, ValueOrder::LCV,     VarOrder::DOM_WDEG, 1.0,  false, 0, 8},
+    {"colors 16-bit",   false, false, ValueOrder::NATURAL, VarOrder::MRV,      1.0,  false, 0, 16},
+};
+
+// smallest k the configuration solves; its coloring is left in `assignment`
+int fuzzChi(const FuzzConfig& cfg) {
+    bool ac3 = USE_AC3, kernels = USE_SMALL_K_KERNELS;
+    ValueOrder vo = VALUE_ORDER;
+    VarOrder var = VAR_ORDER;
+    double decay = WDEG_DECAY;
+    USE_AC3 = cfg.ac3;
+    USE_SMALL_K_KERNELS = cfg.kernels;
+    VALUE_ORDER = cfg.valueOrder;
+    VAR_ORDER = cfg.varOrder;
+    WDEG_DECAY = cfg.wdegDecay;
+    KERNEL_COUNT_BYTES = cfg.countBytes;
+    PACKED_COLOR_BITS = cfg.colorBits;
+
+    int chi = -1;
+    for (int k = 1; k <= max(N, 1) && chi < 0; ++k) {
+        if (cfg.task) {
+            SearchTask task(graphAdj, k);
+            if (task.resume(LLONG_MAX) == SearchStatus::SOLUTION) { assignment = task.colors; chi = k; }
+        } else if (solveWithKColors(k, false)) {
+            chi = k;
+        }
+    }
+
+    USE_AC3 = ac3;
+    USE_SMALL_K_KERNELS = kernels;
+    VALUE_ORDER = vo;
+    VAR_ORDER = var;
+    WDEG_DECAY = decay;
+    KERNEL_COUNT_BYTES = 0;
+    PACKED_COLOR_BITS = 0;
+    return chi;
+}
+
+// true when every check passed; failures are printed one per line
+bool runFuzz(int runs, unsigned baseSeed) {
+    TIME_LIMIT_SEC = 0; // every check needs the complete answer
+    long long checks = 0, failures = 0;
+    for (int run = 0; run < runs; ++run) {
+        unsigned seed = baseSeed + (unsigned)run;
+        mt19937 rng(seed);
+        int nodes = uniform_int_distribution<int>(1, FUZZ_MAX_NODES)(rng);
+        int density = uniform_int_distribution<int>(10, 90)(rng);
+        generateRandomGraph(nodes, density, seed);
+        reserveDomains(N);
+
+        auto check = [&](bool ok, const string& what) {
+            ++checks;
+            if (ok) return;
+            ++failures;
+            cout << "FAIL --seed " << seed << " --nodes " << nodes << " --density " << density
+                 << ": " << what << '\n';
+        };
+        auto verified = [&](const vector<int>& colors, int k, const string& who) {
+            int bad = -1;
+            bool ok = verifyColoring(graphAdj, colors, k, &bad);
+            check(ok, who + ": invalid " + to_string(k) + "-coloring at region " + to_string(bad));
+        };
+
+        int chi = fuzzChi(FUZZ_REFERENCE);
+        check(chi > 0, "reference found no coloring");
+        if (chi <= 0) continue;
+        verified(assignment, chi, FUZZ_REFERENCE.name);
+
+        for (const FuzzConfig& cfg : FUZZ_CONFIGS) {
+            int got = fuzzChi(cfg);
+            check(got == chi, string(cfg.name) + ": chi " + to_string(got) + ", expected " + to_string(chi));
+            if (got > 0) verified(assignment, got, cfg.name);
+        }
+
+        for (int k = 1; k <= chi + 1; ++k) {
+            bool solvable;
+            if (fastPathProbe(k, solvable)) {
+                check(solvable == (k >= chi), string("fast path (") + fastPathReason + ") wrong at k = " + to_string(k));
+                if (solvable) verified(assignment, k, "fast path");
+            }
+            int peeled = peeledProbe(k, false, [](int kk) { return solveWithKColors(kk, false); });
+            if (peeled == -1) continue;
+            check((peeled == 1) == (k >= chi), "core peeling wrong at k = " + to_string(k));
+            if (peeled == 1) verified(assignment, k, "core peeling");
+        }
+
+        CoreDecomposition cd = coreDecomposition();
+        CliqueResult cq = maxClique(cd);
+        check((int)cq.clique.size() <= chi, "clique " + to_string(cq.clique.size()) + " > chi");
+        vector<int> greedy;
+        int ub = greedyColoring(degreeOrder(), greedy);
+        check(ub >= chi, "greedy " + to_string(ub) + " < chi");
+        verified(greedy, ub, "greedy");
+        ChordalResult chordal = chordalColoring();
+        if (chordal.chordal) {
+            check(chordal.chi == chi, "chordal: chi " + to_string(chordal.chi) + ", expected " + to_string(chi));
+            verified(chordal.colors, chordal.chi, "chordal");
+        }
+        SpectralBound spectral = hoffmanBound();
+        check(spectral.bound <= chi, "Hoffman bound " + to_string(spectral.bound) + " > chi");
+        int slUb = greedyColoring(cd.smallestLast(), greedy);
+        check(slUb >= chi && slUb <= cd.degeneracy + 1,
+              "smallest-last greedy " + to_string(slUb) + ", degeneracy " + to_string(cd.degeneracy));
+        verified(greedy, slUb, "smallest-last greedy");
+        if (cd.degeneracy <= 5) {
+            int pu = planarColoring(cd, greedy);
+            check(pu >= chi, "planar coloring " + to_string(pu) + " < chi");
+            verified(greedy, pu, "planar coloring");
+            contractionColoring(greedy);
+            int cu = N ? *max_element(greedy.begin(), greedy.end()) + 1 : 0;
+            check(cu >= chi, "contraction coloring " + to_string(cu) + " < chi");
+            verified(greedy, cu, "contraction coloring");
+            CliqueResult dq = degeneracyClique(cd);
+            check((int)dq.clique.size() == (int)cq.clique.size() || !cq.exact,
+                  "degeneracy clique " + to_string(dq.clique.size()) + " vs " + to_string(cq.clique.size()));
+            for (size_t i = 0; i < dq.clique.size(); ++i)
+                for (size_t j = i + 1; j < dq.clique.size(); ++j)
+                    check(count(graphAdj[dq.clique[i]].begin(), graphAdj[dq.clique[i]].end(), dq.clique[j]) == 1,
+                          "degeneracy clique is not a clique");
+        }
+
+        bool overflowed = false;
+        check(countColorings(chi, &overflowed) > 0, "no " + to_string(chi) + "-colorings counted");
+        check(chi == 1 || countColorings(chi - 1) == 0, to_string(chi - 1) + "-colorings counted");
+
+        long long listed = enumerateColorings(chi, /*breakSymmetry=*/true, [&](const vector<int>& colors) {
+            verified(colors, chi, "enumerate");
+            return true;
+        });
+        check(listed > 0, "enumeration listed nothing");
+
+        // tasks for k = chi-1..chi+1 interleaved a few nodes at a time: each must list
+        // exactly the colorings countColorings finds (skipped when there are too many)
+        long long slice = SEARCH_SLICE_NODES;
+        SEARCH_SLICE_NODES = 3;
+        vector<SearchTask> tasks;
+        vector<uint64_t> expected;
+        for (int k = max(1, chi - 1); k <= chi + 1; ++k) {
+            uint64_t ways = countColorings(k);
+            if (ways > (1 << 16)) continue;
+            tasks.emplace_back(graphAdj, k);
+            expected.push_back(ways);
+        }
+        vector<uint64_t> found(tasks.size(), 0);
+        long long invalid = 0;
+        runInterleaved(tasks, [&](size_t i, const SearchTask& task) {
+            ++found[i];
+            invalid += !verifyColoring(graphAdj, task.colors, task.k, nullptr);
+            return true;
+        });
+        SEARCH_SLICE_NODES = slice;
+        check(invalid == 0, "interleaved tasks: " + to_string(invalid) + " invalid colorings");
+        for (size_t i = 0; i < tasks.size(); ++i)
+            check(found[i] == expected[i], "interleaved task k = " + to_string(tasks[i].k) + ": " +
+                  to_string(found[i]) + " colorings, expected " + to_string(expected[i]));
+
+        overflowed = false;
+        Poly poly = chromaticPolynomial(&overflowed);
+        if (!overflowed) {
+            int polyChi = chromaticNumberFromPolynomial(poly);
+            check(polyChi == chi, "polynomial: chi " + to_string(polyChi) + ", expected " + to_string(chi));
+        }
+    }
+
+    // fixed shapes: a fan (hub over a path, chi 3) and K_n minus three disjoint edges
+    // (chi n - 3), each solved at k = chi through the dispatch main() uses
+    auto setGraph = [](int n, auto edge) {
+        N = n;
+        graphAdj.assign(N, {});
+        for (int u = 0; u < N; ++u)
+            for (int v = u + 1; v < N; ++v)
+                if (edge(u, v)) {
+                    graphAdj[u].push_back(v);
+                    graphAdj[v].push_back(u);
+                }
+        assignment.assign(N, -1);
+        buildEdgeIndex();
+        reserveDomains(N);
+    };
+    auto fixedCheck = [&](int k, bool expected, const string& what) {
+        ++checks;
+        bool ok = solveWithKColors(k, false) == expected &&
+                  (!expected || verifyColoring(graphAdj, assignment, k, nullptr));
+        if (ok) return;
+        ++failures;
+        cout << "FAIL " << what << " at k = " << k << '\n';
+    };
+    setGraph(301, [](int u, int v) { return u == 0 || v == u + 1; });
+    fixedCheck(3, true, "fan of 300 (16-bit kernel counts)");
+    fixedCheck(2, false, "fan of 300 (16-bit kernel counts)");
+    for (int n : {20, 260}) {
+        setGraph(n, [](int u, int v) { return !(u < 6 && v == u + 1 && u % 2 == 0); });
+        fixedCheck(n - 3, true, "K" + to_string(n) + " minus a matching (" + (n < 256 ? "8" : "16") + "-bit colors)");
+    }
+    cout << "fuzz: " << runs << " graphs, " << checks << " checks, " << failures << " failures\n";
+    return failures == 0;
+}
+
+// Command Line 
+// AUTO: k = 3/4 kernels, generic backtracking otherwise; BACKTRACK: generic only;
+// TASK: resumable SearchTask per probe; POLYNOMIAL: chi from P(G, k), then one probe,
+// on at most 64 regions (main() switches bigger graphs to AUTO)
+enum class Engine { AUTO, BACKTRACK, TASK, POLYNOMIAL };
+Engine ENGINE = Engine::AUTO;
+
+string INPUT_PATH;
+InputFormat INPUT_FORMAT = InputFormat::EDGES;
+int GEN_NODES = 0;          // 0: random in [6, 12]
+int GEN_DENSITY = 40;       // edge probability in percent
+bool SEED_SET = false;
+unsigned SEED = 0;
+
+void printUsage(const char* prog) {
+    cout << "usage: " << prog << " [options]\n"
+         << "  --input FILE            read the graph instead of generating one\n"
+         << "  --input-format F        edges (\"u v\", 0-based) | dimacs (default: by extension)\n"
+         << "  --nodes N               generated regions (default: random 6..12)\n"
+         << "  --density P             generated edge probability in percent (default 40)\n"
+         << "  --seed S                generator seed (default: clock)\n"
+         << "  --engine E              auto | backtrack | task | polynomial (<= 64 regions)\n"
+         << "  --propagation P         ac3 | none\n"
+         << "  --fast-paths on|off     closed-form answers for k <= 2, bipartite, low degree, complete\n"
+         << "  --var-order O           mrv | domwdeg | degeneracy\n"
+         << "  --spectral on|off       Hoffman lower bound from Lanczos eigenvalues\n"
+         << "  --planar                the map is planar: Kempe 5/4-coloring, degeneracy clique bound\n"
+         << "  --peeling on|off        search only the k-core of each probe\n"
+         << "  --value-order O         natural | lcv | popular | phase\n"
+         << "  --wdeg-decay X          dom/wdeg decay in (0, 1] (default 1: none)\n"
+         << "  --threads T             worker threads for parallel phases\n"
+         << "  --time-limit SEC        give up the exact search after SEC seconds\n"
+         << "  --clique-ms MS          max clique time limit (default 1000)\n"
+         << "  --output F              text | json | binary\n"
+         << "  --result FILE           write the json/binary record to FILE\n"
+         << "  --quiet                 print only the result line\n"
+         << "  --count                 count the chi-colorings\n"
+         << "  --enumerate             list the chi-colorings up to color permutation (text\n"
+         << "                          output, or json/binary with --result)\n"
+         << "  --svg FILE, --dot FILE  export the colored graph\n"
+         << "  --diagram-max N         skip the ASCII diagram above N regions\n"
+         << "  --layout-iterations N   force-directed layout iterations\n"
+         << "  --trace FILE            write a Chrome trace (chrome://tracing, Perfetto) of the run\n"
+         << "  --perf                  hardware counters per phase (Linux perf_event_open)\n"
+         << "  --fuzz R                check all engines against each other on R random graphs\n"
+         << "                          (seeds from --seed, up to --nodes regions, default 10)\n"
+         << "  --help\n";
+}
+
+// false on a bad or unknown option (message already printed)
+bool parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        string opt = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) return nullptr;
+            return argv[++i];
+        };
+        auto bad = [&](const char* v) {
+            cout << "bad value for " << opt << ": " << (v ? v : "(missing)") << '\n';
+            return false;
+        };
+        auto number = [&](double& out) {
+            const char* v = value();
+            char* end = nullptr;
+            if (v) out = strtod(v, &end);
+            return v && end != v && *end == '\0';
+        };
+        double x;
+
+        if (opt == "--help" || opt == "-h") { printUsage(argv[0]); exit(0); }
+        else if (opt == "--quiet") VERBOSE = false;
+        else if (opt == "--count") COUNT_SOLUTIONS = true;
+        else if (opt == "--perf") PERF_COUNTERS = true;
+        else if (opt == "--planar") PLANAR_INPUT = true;
+        else if (opt == "--enumerate") ENUMERATE_SOLUTIONS = true;
+        else if (opt == "--input") {
+            const char* v = value();
+            if (!v) return bad(v);
+            INPUT_PATH = v;
+            string ext = INPUT_PATH.size() >= 4 ? INPUT_PATH.substr(INPUT_PATH.size() - 4) : "";
+            if (ext == ".col") INPUT_FORMAT = InputFormat::DIMACS;
+        } else if (opt == "--input-format") {
+            const char* v = value();
+            string f = v ? v : "";
+            if (f == "edges") INPUT_FORMAT = InputFormat::EDGES;
+            else if (f == "dimacs") INPUT_FORMAT = InputFormat::DIMACS;
+            else return bad(v);
+        } else if (opt == "--nodes") {
+            if (!number(x) || x < 1) return bad(argv[i]);
+            GEN_NODES = (int)x;
+        } else if (opt == "--density") {
+            if (!number(x) || x < 0 || x > 100) return bad(argv[i]);
+            GEN_DENSITY = (int)x;
+        } else if (opt == "--seed") {
+            if (!number(x)) return bad(argv[i]);
+            SEED = (unsigned)x;
+            SEED_SET = true;
+        } else if (opt == "--engine") {
+            const char* v = value();
+            string e = v ? v : "";
+            if (e == "auto") ENGINE = Engine::AUTO;
+            else if (e == "backtrack") ENGINE = Engine::BACKTRACK;
+            else if (e == "task") ENGINE = Engine::TASK;
+            else if (e == "polynomial") ENGINE = Engine::POLYNOMIAL;
+            else return bad(v);
+        } else if (opt == "--propagation") {
+            const char* v = value();
+            string e = v ? v : "";
+            if (e == "ac3") USE_AC3 = true;
+            else if (e == "none") USE_AC3 = false;
+            else return bad(v);
+        } else if (opt == "--fast-paths") {
+            const char* v = value();
+            string e = v ? v : "";
+            if (e == "on") USE_FAST_PATHS = true;
+            else if (e == "off") USE_FAST_PATHS = false;
+            else return bad(v);
+        } else if (opt == "--spectral") {
+            const char* v = value();
+            string e = v ? v : "";
+            if (e == "on") USE_SPECTRAL_BOUND = true;
+            else if (e == "off") USE_SPECTRAL_BOUND = false;
+            else return bad(v);
+        } else if (opt == "--peeling") {
+            const char* v = value();
+            string e = v ? v : "";
+            if (e == "on") USE_CORE_PEELING = true;
+            else if (e == "off") USE_CORE_PEELING = false;
+            else return bad(v);
+        } else if (opt == "--var-order") {
+            const char* v = value();
+            string e = v ? v : "";
+            if (e == "mrv") VAR_ORDER = VarOrder::MRV;
+            else if (e == "domwdeg") VAR_ORDER = VarOrder::DOM_WDEG;
+            else if (e == "degeneracy") VAR_ORDER = VarOrder::DEGENERACY;
+            else return bad(v);
+        } else if (opt == "--value-order") {
+            const char* v = value();
+            string e = v ? v : "";
+            if (e == "natural") VALUE_ORDER = ValueOrder::NATURAL;
+            else if (e == "lcv") VALUE_ORDER = ValueOrder::LCV;
+            else if (e == "popular") VALUE_ORDER = ValueOrder::POPULAR;
+            else if (e == "phase") VALUE_ORDER = ValueOrder::PHASE;
+            else return bad(v);
+        } else if (opt == "--wdeg-decay") {
+            if (!number(x) || x <= 0 || x > 1) return bad(argv[i]);
+            WDEG_DECAY = x;
+        } else if (opt == "--threads") {
+            if (!number(x) || x < 1) return bad(argv[i]);
+            LAYOUT_THREADS = (int)x;
+        } else if (opt == "--time-limit") {
+            if (!number(x) || x < 0) return bad(argv[i]);
+            TIME_LIMIT_SEC = x;
+        } else if (opt == "--clique-ms") {
+            if (!number(x) || x < 0) return bad(argv[i]);
+            CLIQUE_TIME_LIMIT_MS = (int)x;
+        } else if (opt == "--output") {
+            const char* v = value();
+            string e = v ? v : "";
+            if (e == "text") OUTPUT_FORMAT = OutputFormat::TEXT;
+            else if (e == "json") OUTPUT_FORMAT = OutputFormat::JSON;
+            else if (e == "binary") OUTPUT_FORMAT = OutputFormat::BINARY;
+            else return bad(v);
+        } else if (opt == "--result" || opt == "--svg" || opt == "--dot" || opt == "--trace") {
+            const char* v = value();
+            if (!v) return bad(v);
+            (opt == "--result" ? RESULT_OUTPUT : opt == "--svg" ? SVG_OUTPUT : opt == "--dot" ? DOT_OUTPUT : TRACE_OUTPUT) = v;
+        } else if (opt == "--diagram-max") {
+            if (!number(x) || x < 0) return bad(argv[i]);
+            DIAGRAM_MAX_NODES = (int)x;
+        } else if (opt == "--fuzz") {
+            if (!number(x) || x < 1) return bad(argv[i]);
+            FUZZ_RUNS = (int)x;
+        } else if (opt == "--layout-iterations") {
+            if (!number(x) || x < 0) return bad(argv[i]);
+            LAYOUT_ITERATIONS = (int)x;
+        } else {
+            cout << "unknown option " << opt << '\n';
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    if (ENUMERATE_SOLUTIONS && OUTPUT_FORMAT != OutputFormat::TEXT && RESULT_OUTPUT.empty()) {
+        cout << "--enumerate writes a list to stdout; send the json/binary record to a file with --result\n";
+        return false;
+    }
+    USE_SMALL_K_KERNELS = ENGINE == Engine::AUTO;
+    TRACING = !TRACE_OUTPUT.empty();
+    USE_CHROMATIC_POLYNOMIAL = ENGINE == Engine::POLYNOMIAL;
+    return true;
+}
+
+// the selected engine on the current graph
+bool runEngine(int k, bool verbose) {
+    if (ENGINE != Engine::TASK) return solveWithKColors(k, verbose);
+    profiler.begin("search", k);
+    SearchTask task(graphAdj, k);
+    SearchStatus st;
+    searchNodes = 0;
+    while ((st = task.resume(SEARCH_SLICE_NODES)) == SearchStatus::RUNNING) {
+        searchNodes = task.nodes;
+        if (TIME_LIMIT_SEC > 0 && chrono::steady_clock::now() > searchDeadline) { searchTimedOut = true; break; }
+    }
+    profiler.end();
+    searchNodes = task.nodes;
+    bool res = st == SearchStatus::SOLUTION;
+    if (res) assignment = task.colors;
+    if (verbose) cout << (res ? "  Resumable search found a solution.\n" : "  Resumable search found NO solution.\n");
+    return res;
+}
+
+// one k probe: the fast paths first, then the engine on the k-core
+bool runProbe(int k, bool verbose) {
+    bool solvable;
+    searchNodes = 0;
+    if (USE_FAST_PATHS && fastPathProbe(k, solvable)) {
+        if (verbose) cout << "  Fast path (" << fastPathReason << "): " << (solvable ? "solvable\n" : "NOT solvable\n");
+        return solvable;
+    }
+    if (USE_CORE_PEELING) {
+        int peeled = peeledProbe(k, verbose, [&](int kk) { return runEngine(kk, verbose); });
+        if (peeled != -1) return peeled == 1;
+    }
+    return runEngine(k, verbose);
+}
+
+
+int main(int argc, char** argv) {
+    if (!parseArgs(argc, argv)) return 1;
+    if (FUZZ_RUNS > 0) {
+        if (GEN_NODES > 0) FUZZ_MAX_NODES = GEN_NODES;
+        return runFuzz(FUZZ_RUNS, SEED_SET ? SEED : 1) ? 0 : 1;
+    }
+
+    profiler.begin("input");
+    if (!INPUT_PATH.empty()) {
+        if (!loadGraph(INPUT_PATH, INPUT_FORMAT)) {
+            cout << "Could not read graph from " << INPUT_PATH << '\n';
+            return 1;
+        }
+    } else {
+        // pick a random N between 6 and 12 unless --nodes is given
+        unsigned seed = SEED_SET ? SEED : (unsigned)chrono::system_clock::now().time_since_epoch().count();
+        mt19937 rng(seed);
+        uniform_int_distribution<int> distNodes(6, 12);
+        N = GEN_NODES > 0 ? GEN_NODES : distNodes(rng);
+
+        // generate graph (keeps original generator logic)
+        generateRandomGraph(N, GEN_DENSITY, seed);
+    }
+    profiler.end();
+
+    // a machine-readable report on stdout replaces the console text
+    if (OUTPUT_FORMAT != OutputFormat::TEXT && RESULT_OUTPUT.empty()) VERBOSE = false;
+    bool textResult = OUTPUT_FORMAT == OutputFormat::TEXT || !RESULT_OUTPUT.empty();
+    if (ENGINE == Engine::POLYNOMIAL && N > 64) {
+        if (textResult) cout << "The polynomial engine takes at most 64 regions, not " << N << "; using the auto engine\n";
+        ENGINE = Engine::AUTO;
+        USE_SMALL_K_KERNELS = true;
+        USE_CHROMATIC_POLYNOMIAL = false;
+    }
+    auto runStart = chrono::steady_clock::now();
+    searchDeadline = runStart + chrono::duration_cast<chrono::steady_clock::duration>(
+                                    chrono::duration<double>(TIME_LIMIT_SEC));
+    auto msSince = [](chrono::steady_clock::time_point t0) {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    };
+    RunReport report;
+
+    // print adjacency list + diagram
+    if (VERBOSE) {
+        printAdjacencyList();
+        printGraphDiagram();
+    }
+
+    // bounds: chi >= |clique|, chi <= greedy colors
+    profiler.begin("bounds");
+    // chordal: the PEO gives omega, a maximum clique and an optimal coloring at once
+    ChordalResult chordal;
+    if (USE_FAST_PATHS) chordal = chordalColoring();
+    // planar maps: --planar, or the necessary E <= 3N - 6 and degeneracy <= 5
+    CoreDecomposition cores = coreDecomposition();
+    long long edges = adjOffset[N] / 2;
+    bool planar = USE_FAST_PATHS && !chordal.chordal && cores.degeneracy <= 5 &&
+                  (PLANAR_INPUT || N < 3 || edges <= 3LL * N - 6);
+    CliqueResult cq;
+    if (chordal.chordal) cq = {chordal.clique, true};
+    else if (planar) cq = degeneracyClique(cores);
+    else cq = maxClique(cores);
+    int lb = max(1, (int)cq.clique.size());
+    vector<int> greedyColors, slColors;
+    int ub = greedyColoring(degreeOrder(), greedyColors);
+    int slUb = greedyColoring(cores.smallestLast(), slColors); // <= degeneracy + 1
+    if (slUb < ub) {
+        ub = slUb;
+        greedyColors.swap(slColors);
+    }
+    if (chordal.chordal) {
+        ub = max(1, chordal.chi);
+        greedyColors = chordal.colors;
+    }
+    int planarUb = 0;
+    if (planar) {
+        planarUb = planarColoring(cores, slColors);
+        if (planarUb < ub) {
+            ub = planarUb;
+            greedyColors.swap(slColors);
+        }
+    }
+    profiler.end();
+
+    // spectral lower bound, only worth it while the bounds are apart
+    SpectralBound spectral;
+    if (USE_SPECTRAL_BOUND && lb < ub) {
+        profiler.begin("spectral");
+        spectral = hoffmanBound(lb);
+        profiler.end();
+        lb = max(lb, min(spectral.bound, ub));
+    }
+    if (VERBOSE) {
+        cout << "\nMax clique: " << cq.clique.size() << (cq.exact ? " (exact)" : " (time or size limit hit)") << " -> {";
+        for (int i = 0; i < (int)cq.clique.size(); ++i) cout << (i ? ", " : "") << cq.clique[i];
+        cout << "}\n";
+        if (chordal.chordal) cout << "Chordal: chi = omega = " << chordal.chi << " (perfect elimination order)\n";
+        cout << "Degeneracy: " << cores.degeneracy << " (chi <= " << cores.degeneracy + 1 << ")\n";
+        if (planar) cout << "Planar coloring (Kempe swaps): " << planarUb << " colors\n";
+        if (spectral.steps)
+            cout << "Hoffman bound: chi >= " << spectral.bound << " (lambda max " << spectral.lambdaMax
+                 << ", min " << spectral.lambdaMin << ", " << spectral.steps << " Lanczos steps"
+                 << (spectral.converged ? "" : ", not converged") << ")\n";
+        cout << "Greedy coloring: " << ub << " colors\n";
+    }
+
+    // exact chi from P(G, k) > 0, small graphs only
+    if (USE_CHROMATIC_POLYNOMIAL) {
+        bool overflowed = false, late = false;
+        profiler.begin("polynomial");
+        Poly poly = chromaticPolynomial(&overflowed, &late);
+        profiler.end();
+        if (late) {
+            if (VERBOSE) cout << "Chromatic polynomial: time limit hit, falling back to the k loop\n";
+        } else if (!overflowed) {
+            if (VERBOSE) cout << "Chromatic polynomial: " << formatPolynomial(poly) << '\n';
+            int chi = chromaticNumberFromPolynomial(poly);
+            if (VERBOSE) cout << "P(G, k) > 0 first at k = " << chi << '\n';
+            lb = max(lb, chi);
+        } else if (VERBOSE) {
+            cout << "Chromatic polynomial: coefficients overflowed, not used\n";
+        }
+    }
+
+    // run minimal color search
+    int foundK = -1;
+    if (lb == ub) {
+        if (VERBOSE) cout << "\nBounds meet, no search needed\n";
+        foundK = ub;
+        assignment = greedyColors;
+    } else {
+        if (VERBOSE) cout << "\nsolving (trying k = " << lb << ".." << ub - 1 << ")\n";
+        reserveDomains(ub - 1);
+        for (int k = lb; k < ub; ++k) {
+            if (VERBOSE) cout << "Trying k = " << k << " ...\n";
+            auto probeStart = chrono::steady_clock::now();
+            TraceScope trace("probe", k);
+            bool ok = runProbe(k, VERBOSE);
+            ProbeStatus status = ok ? ProbeStatus::SAT : searchTimedOut ? ProbeStatus::TIMED_OUT : ProbeStatus::UNSAT;
+            report.probes.push_back({k, status, msSince(probeStart), searchNodes});
+            if (ok) { foundK = k; break; }
+            if (searchTimedOut) {
+                if (VERBOSE) cout << "Time limit hit at k = " << k << ", keeping the greedy coloring\n";
+                break;
+            }
+        }
+        if (foundK == -1) { // nothing below the greedy bound (or out of time)
+            foundK = ub;
+            assignment = greedyColors;
+        }
+    }
+
+    if (foundK != -1) {
+        // every engine's answer goes through the same O(N + E) check
+        int bad = -1;
+        if (!verifyColoring(graphAdj, assignment, foundK, &bad)) {
+            cout << "Internal error: invalid " << foundK << "-coloring at region " << bad << '\n';
+            return 2;
+        }
+        if (VERBOSE) {
+            cout << "\nSolution found with " << foundK << " colors:\n";
+            printSolution(assignment);
+        } else if (textResult) {
+            cout << "Solution found with " << foundK << " colors\n";
+        }
+
+        if (COUNT_SOLUTIONS) {
+            bool overflowed = false, incomplete = false;
+            profiler.begin("count");
+            uint64_t ways = countColorings(foundK, &overflowed, &incomplete);
+            profiler.end();
+            report.counted = true;
+            report.count = ways;
+            report.countOverflowed = overflowed;
+            report.countIncomplete = incomplete;
+            if (textResult)
+                cout << "\nNumber of " << foundK << "-colorings: "
+                     << (overflowed || incomplete ? ">= " : "") << ways
+                     << (incomplete ? " (time limit hit, count incomplete)" : "") << '\n';
+        }
+        if (ENUMERATE_SOLUTIONS) { // parseArgs() keeps stdout free for the list
+            cout << "\nAll " << foundK << "-colorings up to color permutation:\n" << flush;
+            long long count;
+            bool incomplete = false;
+            profiler.begin("enumerate");
+            {
+                BufferedWriter out(stdout, 1 << 20);
+                count = enumerateColorings(foundK, /*breakSymmetry=*/true, [&](const vector<int>& colors){
+                    for (int i = 0; i < N; ++i) out << colors[i] << (i + 1 < N ? ' ' : '\n');
+                    return true;
+                }, &incomplete);
+            }
+            profiler.end();
+            cout << count << " colorings" << (incomplete ? " (time limit hit, list incomplete)" : "") << '\n';
+        }
+
+        if (!DOT_OUTPUT.empty() || !SVG_OUTPUT.empty()) profiler.begin("export");
+        if (!DOT_OUTPUT.empty()) {
+            bool ok = exportDot(DOT_OUTPUT, assignment);
+            if (VERBOSE || !ok) cout << (ok ? "\nWrote " : "\nCould not write ") << DOT_OUTPUT << '\n';
+        }
+        if (!SVG_OUTPUT.empty()) {
+            int side = max(400, (int)(sqrt((double)N) * 40));
+            vector<Coord> coords = generateCoordinates(side, side);
+            bool ok = exportSvg(SVG_OUTPUT, assignment, coords, side, side);
+            if (VERBOSE || !ok) cout << (ok ? "\nWrote " : "\nCould not write ") << SVG_OUTPUT << '\n';
+        }
+        if (!DOT_OUTPUT.empty() || !SVG_OUTPUT.empty()) profiler.end();
+    } else {
+        cout << "\nNo valid coloring found for k in [1.." << N << "].\n";
+    }
+
+    if (PERF_COUNTERS && textResult) printPhases();
+
+    if (OUTPUT_FORMAT != OutputFormat::TEXT) {
+        report.regions = N;
+        report.edges = adjOffset[N] / 2;
+        report.chi = foundK;
+        report.lowerBound = lb;
+        report.upperBound = ub;
+        report.cliqueExact = cq.exact;
+        report.timedOut = searchTimedOut;
+        report.totalMs = msSince(runStart);
+        report.colors = &assignment;
+        report.phases = &profiler.records;
+        if (!emitReport(report)) cout << "Could not write " << RESULT_OUTPUT << '\n';
+    }
+
+    if (TRACING) {
+        bool ok = writeTrace(TRACE_OUTPUT);
+        if (VERBOSE || !ok) cout << (ok ? "\nWrote " : "\nCould not write ") << TRACE_OUTPUT << '\n';
     }
 
     return 0;